@@ -0,0 +1,132 @@
+/*
+arena.c -- implementation of a chunked bump allocator
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+
+/*ALLOCATES A NEW CHUNK ABLE TO HOLD AT LEAST size BYTES*/
+static arena_chunk *
+initialize_new_arena_chunk(size_t size)
+{
+	arena_chunk *c = NULL;
+
+	c = xmalloc(sizeof(arena_chunk) + size);
+	c->next = NULL;
+	c->size = size;
+	c->used = 0;
+
+	return c;
+}
+
+
+/*ALLOCATES AN EMPTY ARENA. CHUNKS OF chunk_size BYTES ARE ADDED ON DEMAND*/
+arena *
+initialize_new_arena(size_t chunk_size)
+{
+	arena *a = NULL;
+
+	assert(chunk_size > 0);
+
+	a = xcalloc(1, sizeof(arena));
+	a->chunk_size = chunk_size;
+	a->first = initialize_new_arena_chunk(chunk_size);
+	a->current = a->first;
+
+	return a;
+}
+
+
+/*RETURNS size BYTES OF UNINITIALIZED, SUITABLY ALIGNED MEMORY FROM ARENA a */
+/*THE MEMORY IS RELEASED ONLY BY reset_arena() OR clean_arena()           */
+void *
+arena_alloc(arena *a, size_t size)
+{
+	arena_chunk *c = NULL;
+	void *m = NULL;
+
+	assert(a != NULL);
+
+	size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+	c = a->current;
+
+	/*MOVE TO THE NEXT CHUNK (REUSING ONES LEFT OVER BY A RESET) UNTIL ONE FITS*/
+	while(c->used + size > c->size)
+	{
+		if(c->next == NULL)
+		{
+			c->next = initialize_new_arena_chunk((size > a->chunk_size)? size : a->chunk_size);
+		}
+		c = c->next;
+		c->used = 0;
+	}
+	a->current = c;
+
+	m = c->data + c->used;
+	c->used += size;
+
+	return m;
+}
+
+
+/*COPIES THE NULL TERMINATED STRING s IN ARENA a AND RETURNS THE COPY*/
+char *
+arena_strdup(arena *a, char *s)
+{
+	char *d = NULL;
+	size_t len;
+
+	assert(s != NULL);
+
+	len = strlen(s) + sizeof(char);
+	d = arena_alloc(a, len);
+	memcpy(d, s, len);
+
+	return d;
+}
+
+
+/*RELEASES ALL ALLOCATIONS AT ONCE. CHUNKS ARE KEPT AND REUSED*/
+void
+reset_arena(arena *a)
+{
+	assert(a != NULL);
+
+	a->current = a->first;
+	a->first->used = 0;
+}
+
+
+/*FREES ALL MEMORY USED BY ARENA a, INCLUDING THE ARENA ITSELF*/
+void
+clean_arena(arena *a)
+{
+	arena_chunk *c = NULL;
+
+	assert(a != NULL);
+
+	c = a->first;
+	while(c != NULL)
+	{
+		arena_chunk *next = c->next;
+
+		free(c);
+		c = next;
+	}
+	free(a);
+}
@@ -0,0 +1,243 @@
+/*
+batch.c -- generator states and multi-threaded generation of random sentences
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <pthread.h>
+
+/*WORK OF A SINGLE THREAD IN A ROUND OF generate_batch(): SENTENCES FROM*/
+/*first TO last-1 ARE WRITTEN IN MEMORY, AND COPIED TO THE OUTPUT LATER */
+typedef struct BATCH_WORK
+{
+	generator_context *ctx;
+	generation_state *gs;
+	int first;
+	int last;
+	int repeat;
+	char *separator;
+	/*STREAM RECEIVING THE PARSE TREES (IT MAY BE THE SAME AS gs->output)*/
+	FILE *tree_output;
+	/*MEMORY BUFFERS BEHIND gs->output AND tree_output*/
+	char *text;
+	size_t text_size;
+	char *tree;
+	size_t tree_size;
+} batch_work;
+
+
+/*ALLOCATES A GENERATOR STATE WRITING ON output, WITH IT'S OWN STACK AND*/
+/*(IF with_tree IS NOT ZERO) IT'S OWN PARSE TREE                        */
+generation_state *
+initialize_new_generation_state(FILE *output, symbol_id starting_symbol, int with_tree)
+{
+	generation_state *gs = NULL;
+
+	gs = xcalloc(1, sizeof(generation_state));
+	gs->output = output;
+	gs->buffer = xmalloc(OUTPUT_BUFFER_SIZE);
+	gs->buffer_size = OUTPUT_BUFFER_SIZE;
+	gs->st = initialize_new_stack();
+	gs->terminals = initialize_new_stack();
+	if(with_tree != 0)
+		gs->pt = init_parse_tree(starting_symbol);
+	seed_generation_state(gs, 0, 0);
+
+	return gs;
+}
+
+
+/*FREES THE GENERATOR STATE gs. THE OUTPUT STREAM IS NOT CLOSED, AND IT'S*/
+/*BUFFER MUST HAVE BEEN FLUSHED ALREADY                                  */
+void
+clean_generation_state(generation_state *gs)
+{
+	assert(gs != NULL);
+	assert(gs->buffer_used == 0);
+
+	free(gs->buffer);
+	clean_stack(gs->st);
+	clean_stack(gs->terminals);
+	if(gs->pt != NULL)
+		parse_tree_clean(gs->pt);
+	free(gs);
+}
+
+
+/*GENERATES SENTENCE NUMBER j (COUNTING FROM ZERO), FOLLOWED BY IT'S PARSE*/
+/*TREE AND, UNLESS IT IS THE LAST ONE, BY THE SENTENCE SEPARATOR          */
+static void
+generate_batch_sentence(batch_work *w, int j)
+{
+	generator_context *ctx = w->ctx;
+	generation_state *gs = w->gs;
+
+	seed_generation_state(gs, ctx->seed, (unsigned long) j);
+	if(ctx->lengths != NULL)
+		grow_length(ctx, gs);
+	else if(ctx->boltzmann_max_size >= 0)
+		grow_boltzmann(ctx, gs);
+	else
+		grow(ctx, gs);
+
+	/*THE TREE MAY GO ON THE SAME STREAM AS THE SENTENCE*/
+	if(ctx->parse_tree_mode != NO_TREE)
+		flush_output(gs);
+
+	if(ctx->parse_tree_mode == PRETTY_TREE)
+	{
+		fputs("\n", w->tree_output);
+		print_tree(w->tree_output, gs->pt->root, ctx->symbol_table);
+	}
+	else if(ctx->parse_tree_mode == COMPACT_TREE)
+	{
+		fputs("\n", w->tree_output);
+		print_tree_compact(w->tree_output, gs->pt->root, ctx->symbol_table);
+	}
+
+	if(j < w->repeat-1)
+		write_output(gs, w->separator, strlen(w->separator));
+}
+
+
+/*THREAD BODY: GENERATES THE SENTENCES ASSIGNED TO w IN IT'S BUFFERS*/
+static void *
+generate_batch_worker(void *arg)
+{
+	batch_work *w = (batch_work *) arg;
+	int j;
+
+	use_generator_context(w->ctx);
+	for(j = w->first; j < w->last; j++)
+	{
+		generate_batch_sentence(w, j);
+	}
+	flush_output(w->gs);
+
+	return NULL;
+}
+
+
+/*GENERATES repeat RANDOM SENTENCES ON THE OUTPUT STREAM OF ctx, WITH jobs */
+/*THREADS. EVERY SENTENCE HAS IT'S OWN RANDOM SEQUENCE, DERIVED FROM THE   */
+/*SEED OF ctx AND IT'S NUMBER, SO THE OUTPUT IS THE SAME WHATEVER THE      */
+/*NUMBER OF THREADS. WITH MORE THAN ONE THREAD, SENTENCES ARE GENERATED IN */
+/*ROUNDS: EVERY THREAD WRITES BATCH_SENTENCES_PER_JOB CONSECUTIVE SENTENCES*/
+/*IN MEMORY, THEN THE BUFFERS ARE COPIED TO THE OUTPUT IN ORDER            */
+void
+generate_batch(generator_context *ctx, int repeat, int jobs, char *separator)
+{
+	int t, first;
+	int with_tree;
+	batch_work *work = NULL;
+	pthread_t *threads = NULL;
+
+	assert(ctx != NULL);
+	assert(ctx->symbol_table != NULL);
+	assert(ctx->output_stream != NULL);
+	assert(repeat >= 0);
+	assert(jobs >= 1);
+
+	with_tree = (ctx->parse_tree_mode != NO_TREE);
+	work = xcalloc(jobs, sizeof(batch_work));
+	for(t = 0; t < jobs; t++)
+	{
+		work[t].ctx = ctx;
+		work[t].gs = initialize_new_generation_state(ctx->output_stream, ctx->starting_symbol, with_tree);
+		work[t].repeat = repeat;
+		work[t].separator = separator;
+		work[t].tree_output = stdout;
+	}
+
+	/*A SINGLE THREAD WRITES DIRECTLY ON THE OUTPUT*/
+	if(jobs == 1)
+	{
+		work[0].first = 0;
+		work[0].last = repeat;
+		generate_batch_worker(&(work[0]));
+	}
+	else
+	{
+		threads = xcalloc(jobs, sizeof(pthread_t));
+
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "generating %d sentences with %d threads\n", repeat, jobs);
+
+		for(first = 0; first < repeat; first += jobs * BATCH_SENTENCES_PER_JOB)
+		{
+			for(t = 0; t < jobs; t++)
+			{
+				batch_work *w = &(work[t]);
+				int ret;
+
+				w->first = first + t * BATCH_SENTENCES_PER_JOB;
+				w->last = w->first + BATCH_SENTENCES_PER_JOB;
+				w->first = (w->first > repeat)? repeat : w->first;
+				w->last = (w->last > repeat)? repeat : w->last;
+
+				w->gs->output = open_memstream(&(w->text), &(w->text_size));
+				if(w->gs->output == NULL)
+					error(UNEXPECTED_ERROR, errno, "%s", "could not open a memory stream");
+
+				/*PARSE TREES GO ON stdout: IF THE SENTENCES DO AS WELL, THEY */
+				/*MUST BE INTERLEAVED IN THE SAME BUFFER                      */
+				if(ctx->standard_output_flag == 1 || with_tree == 0)
+					w->tree_output = w->gs->output;
+				else
+				{
+					w->tree_output = open_memstream(&(w->tree), &(w->tree_size));
+					if(w->tree_output == NULL)
+						error(UNEXPECTED_ERROR, errno, "%s", "could not open a memory stream");
+				}
+
+				ret = pthread_create(&(threads[t]), NULL, generate_batch_worker, w);
+				if(ret != 0)
+					error(UNEXPECTED_ERROR, ret, "%s", "could not create a generation thread");
+			}
+
+			/*COPY THE BUFFERS IN ORDER, AS SOON AS THEIR THREAD IS DONE*/
+			for(t = 0; t < jobs; t++)
+			{
+				batch_work *w = &(work[t]);
+				int ret;
+
+				ret = pthread_join(threads[t], NULL);
+				if(ret != 0)
+					error(UNEXPECTED_ERROR, ret, "%s", "could not join a generation thread");
+
+				if(w->tree_output != w->gs->output)
+				{
+					fclose(w->tree_output);
+					fwrite(w->tree, sizeof(char), w->tree_size, stdout);
+					free(w->tree);
+				}
+				fclose(w->gs->output);
+				fwrite(w->text, sizeof(char), w->text_size, ctx->output_stream);
+				free(w->text);
+			}
+		}
+
+		free(threads);
+	}
+
+	for(t = 0; t < jobs; t++)
+	{
+		clean_generation_state(work[t].gs);
+	}
+	free(work);
+}
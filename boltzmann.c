@@ -0,0 +1,642 @@
+/*
+boltzmann.c -- Boltzmann generation of random sentences of a given expected size
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <math.h>
+
+/*THE GENERATING FUNCTION OF A NON-TERMINAL A IS                            */
+/*    A(x) = SUM OVER THE RULES r OF A OF  w(r) * x^t(r) * PRODUCT OF B(x)   */
+/*WHERE w(r) IS THE PROBABILITY OF THE RULE OVER THE LEAST PROBABILITY OF  */
+/*THE RULES OF A (1 FOR ALL RULES BY DEFAULT, 2 FOR TWO RULES MERGED BY     */
+/*normalize_rules()), t(r) IT'S NUMBER OF TERMINALS AND B RANGES OVER IT'S  */
+/*NON-TERMINALS. FOR A GIVEN x, CHOOSING EVERY RULE r OF A WITH PROBABILITY */
+/*w(r) * x^t(r) * PRODUCT OF B(x) / A(x) DRAWS EVERY SENTENCE OF n TOKENS   */
+/*WITH PROBABILITY PROPORTIONAL TO x^n: SENTENCES OF THE SAME SIZE ARE      */
+/*EQUALLY LIKELY, AND x SETS THE EXPECTED SIZE. THE VALUES A(x) ARE THE     */
+/*LEAST SOLUTION OF THE SYSTEM, FOUND BY NEWTON'S METHOD; x IS FOUND BY     */
+/*BISECTION, AS THE EXPECTED SIZE GROWS WITH x. THE JACOBIAN HAS ONE ENTRY  */
+/*PER NON-TERMINAL IN A RULE, AND THE LINEAR SYSTEMS OF NEWTON'S METHOD ARE */
+/*SOLVED BY BICGSTAB ITERATIONS, EACH ONE LINEAR IN THE SIZE OF THE GRAMMAR */
+
+#define NEWTON_MAX_ITERATIONS 200
+#define NEWTON_TOLERANCE 1e-13
+#define LINEAR_MAX_ITERATIONS 1000
+#define LINEAR_TOLERANCE 1e-12
+#define BREAKDOWN_TOLERANCE 1e-8
+#define STEP_TOLERANCE 1e-3
+#define BISECTION_STEPS 100
+#define BISECTION_TOLERANCE 1e-3
+#define MAX_PARAMETER 1e12
+
+/*THE SYSTEM OF THE GENERATING FUNCTIONS: ONE EQUATION PER NON-TERMINAL*/
+typedef struct BOLTZMANN_SYSTEM
+{
+	symbol_list_entry *symbol_table;
+	grammar_image *image;
+	/*index[s] IS THE EQUATION OF NON-TERMINAL s, -1 FOR TERMINALS*/
+	int *index;
+	int size;
+	/*PER RULE: WEIGHT AND NUMBER OF TERMINALS*/
+	double *weight;
+	int *terminals;
+	/*THE ENTRIES OF THE JACOBIAN, IN THE ORDER OF THE NON-TERMINALS OF THE*/
+	/*RULES: jacobian[e] IS THE DERIVATIVE OF EQUATION row[e] IN column[e],*/
+	/*TIMES scale[column[e]] / scale[row[e]]                               */
+	int entries;
+	int *row;
+	int *column;
+	double *jacobian;
+	/*VALUES, VALUES NEWTON'S METHOD STARTS FROM, DERIVATIVES IN x, RIGHT-*/
+	/*HAND SIDE OF THE LINEAR SYSTEM, SCALE OF THE UNKNOWNS AND SCRATCH   */
+	/*SPACE OF THE SOLVER. THE VALUES CAN SPAN MANY ORDERS OF MAGNITUDE:  */
+	/*SCALED BY THE VALUES, THE ENTRIES OF THE JACOBIAN ARE BOUNDED BY THE*/
+	/*LENGTHS OF THE RULES                                                */
+	double *y;
+	double *start;
+	double *dx;
+	double *rhs;
+	double *scale;
+	double *work;
+} boltzmann_system;
+
+
+/*COMPUTES IN out THE PRODUCT OF (I - jacobian) AND v*/
+static void
+multiply_system(boltzmann_system *b, double *v, double *out)
+{
+	int i;
+
+	for(i = 0; i < b->size; i++)
+	{
+		out[i] = v[i];
+	}
+	for(i = 0; i < b->entries; i++)
+	{
+		out[b->row[i]] -= b->jacobian[i] * v[b->column[i]];
+	}
+}
+
+
+/*RETURNS THE SCALAR PRODUCT OF u AND v, OF size ELEMENTS*/
+static double
+dot_product(double *u, double *v, int size)
+{
+	int i;
+	double sum = 0.0;
+
+	for(i = 0; i < size; i++)
+	{
+		sum += u[i] * v[i];
+	}
+	return sum;
+}
+
+
+/*SOLVES (I - jacobian) * v = rhs BY THE BICGSTAB METHOD, FOR v / scale */
+/*AS jacobian IS SCALED. THE SOLUTION IS LEFT IN rhs. THE METHOD BREAKS  */
+/*DOWN WHEN THE SHADOW RESIDUAL r0 GETS ORTHOGONAL TO THE RESIDUAL, AS IN*/
+/*THE CHAINS OF UNIT RULES OF LAYERED EXPRESSIONS, OR TO ITS PRODUCT BY  */
+/*THE MATRIX: THEN IT RESTARTS FROM THE CURRENT SOLUTION, WITH A RANDOM  */
+/*LOOKING r0 AND THE RESIDUAL COMPUTED AGAIN, AS THE ONE UPDATED AT EVERY*/
+/*ITERATION DRIFTS. RETURNS 0 IF THE ITERATIONS DO NOT CONVERGE, AS WHEN */
+/*THE MATRIX IS SINGULAR                                                 */
+static int
+solve_linear_system(boltzmann_system *b)
+{
+	int i, iteration, m = b->size, restart = 0, restarts = 0;
+	double *v = b->work, *r = v + m, *r0 = r + m, *p = r0 + m;
+	double *q = p + m, *t = q + m;
+	double rho = 1.0, alpha = 1.0, omega = 1.0, limit, norm;
+
+	for(i = 0; i < m; i++)
+	{
+		b->rhs[i] /= b->scale[i];
+		v[i] = p[i] = q[i] = 0.0;
+		r[i] = r0[i] = b->rhs[i];
+	}
+	limit = LINEAR_TOLERANCE * sqrt(dot_product(r, r, m));
+
+	for(iteration = 0; ; iteration++)
+	{
+		double previous = rho, beta, d;
+
+		if(restart != 0)
+		{
+			multiply_system(b, v, r);
+			for(i = 0; i < m; i++)
+			{
+				r[i] = b->rhs[i] - r[i];
+			}
+		}
+		norm = sqrt(dot_product(r, r, m));
+		if(norm <= limit)
+			break;
+		if(iteration == LINEAR_MAX_ITERATIONS || isfinite(norm) == 0)
+			return 0;
+		if(restart != 0)
+		{
+			unsigned int seed = ++restarts;
+
+			for(i = 0; i < m; i++)
+			{
+				seed = seed * 1103515245u + 12345u;
+				r0[i] = 0.5 + (seed >> 8) / 16777216.0;
+				p[i] = q[i] = 0.0;
+			}
+			previous = alpha = omega = 1.0;
+			restart = 0;
+		}
+
+		rho = dot_product(r0, r, m);
+		if(fabs(rho) <= BREAKDOWN_TOLERANCE * norm * sqrt(dot_product(r0, r0, m)))
+		{
+			restart = 1;
+			continue;
+		}
+		beta = (rho / previous) * (alpha / omega);
+		for(i = 0; i < m; i++)
+		{
+			p[i] = r[i] + beta * (p[i] - omega * q[i]);
+		}
+		multiply_system(b, p, q);
+		d = dot_product(r0, q, m);
+		if(fabs(d) <= BREAKDOWN_TOLERANCE * sqrt(dot_product(r0, r0, m) * dot_product(q, q, m)))
+		{
+			restart = 1;
+			continue;
+		}
+		alpha = rho / d;
+		for(i = 0; i < m; i++)
+		{
+			v[i] += alpha * p[i];
+			r[i] -= alpha * q[i];
+		}
+		if(sqrt(dot_product(r, r, m)) <= limit)
+			break;
+
+		/*r IS NOW THE s OF THE METHOD*/
+		multiply_system(b, r, t);
+		d = dot_product(t, t, m);
+		omega = (d > 0.0)? dot_product(t, r, m) / d : 0.0;
+		if(omega == 0.0)
+		{
+			restart = 1;
+			continue;
+		}
+		for(i = 0; i < m; i++)
+		{
+			v[i] += omega * r[i];
+			r[i] -= omega * t[i];
+		}
+	}
+
+	for(i = 0; i < m; i++)
+	{
+		b->rhs[i] = v[i] * b->scale[i];
+	}
+	return 1;
+}
+
+
+/*COMPUTES IN rhs THE RIGHT-HAND SIDES OF THE SYSTEM MINUS y, AND IN   */
+/*jacobian AND dx THEIR DERIVATIVES IN THE VALUES y AND IN x, SCALED BY*/
+/*THE VALUES y. RETURNS THE LARGEST RELATIVE DIFFERENCE BETWEEN THE    */
+/*RIGHT-HAND SIDES AND y                                               */
+static double
+evaluate_system(boltzmann_system *b, double x)
+{
+	int i, e = 0, m = b->size;
+	double residual = 0.0;
+
+
+	for(i = 0; i < m; i++)
+	{
+		b->rhs[i] = -b->y[i];
+		b->dx[i] = 0.0;
+		b->scale[i] = (b->y[i] > 0.0)? b->y[i] : 1.0;
+	}
+
+	for(i = 0; i < b->image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(b->image->rules[i]);
+		int a = b->index[b->image->rule_lhs[i]];
+		double c = b->weight[i] * pow(x, b->terminals[i]);
+		double prefix[rle->length + 1], suffix[rle->length + 1];
+		int j;
+
+		/*PRODUCTS OF THE VALUES OF THE SYMBOLS BEFORE AND AFTER EVERY POSITION*/
+		prefix[0] = 1.0;
+		for(j = 0; j < rle->length; j++)
+		{
+			int k = b->index[rle->rhs[j]];
+
+			prefix[j + 1] = prefix[j] * ((k >= 0)? b->y[k] : 1.0);
+		}
+		suffix[rle->length] = 1.0;
+		for(j = rle->length - 1; j >= 0; j--)
+		{
+			int k = b->index[rle->rhs[j]];
+
+			suffix[j] = suffix[j + 1] * ((k >= 0)? b->y[k] : 1.0);
+		}
+
+		b->rhs[a] += c * prefix[rle->length];
+		if(b->terminals[i] > 0)
+			b->dx[a] += b->weight[i] * b->terminals[i] * pow(x, b->terminals[i] - 1) * prefix[rle->length];
+		for(j = 0; j < rle->length; j++)
+		{
+			int k = b->index[rle->rhs[j]];
+
+			if(k >= 0)
+				b->jacobian[e++] = c * prefix[j] * suffix[j + 1] * b->scale[k] / b->scale[a];
+		}
+	}
+
+	for(i = 0; i < m; i++)
+	{
+		double r = fabs(b->rhs[i]) / ((b->y[i] > 1.0)? b->y[i] : 1.0);
+
+		if(isfinite(r) == 0)
+			return INFINITY;
+		if(r > residual)
+			residual = r;
+	}
+
+	return residual;
+}
+
+
+/*COMPUTES THE VALUES OF THE GENERATING FUNCTIONS AT x IN y, AND RETURNS*/
+/*THE EXPECTED NUMBER OF TOKENS OF THE SENTENCES OF THE STARTING SYMBOL */
+/*RETURNS A NEGATIVE VALUE IF x IS PAST THE CONVERGENCE RADIUS. NEWTON'S*/
+/*METHOD STARTS FROM THE VALUES IN start, WHICH MUST BE ZERO OR THE     */
+/*VALUES AT A SMALLER x                                                 */
+static double
+expected_size(boltzmann_system *b, double x, symbol_id starting_symbol)
+{
+	int i, iteration, m = b->size, s = b->index[starting_symbol];
+
+	for(i = 0; i < m; i++)
+	{
+		b->y[i] = b->start[i];
+	}
+
+	/*NEWTON'S METHOD FROM BELOW THE LEAST SOLUTION REACHES IT, IF ANY: THE*/
+	/*VALUES AT A SMALLER x ARE BELOW, AS THE VALUES GROW WITH x. THERE THE*/
+	/*STEPS ARE NEVER NEGATIVE: A NEGATIVE STEP MEANS THAT x IS BEYOND THE */
+	/*RADIUS, AND IT IS NOT WORTH ITERATING UNTIL THE VALUES GO NEGATIVE.  */
+	/*ONE STEP IS TAKEN EVEN FROM VALUES WITHIN THE TOLERANCE: NEAR THE    */
+	/*RADIUS, THE EXPECTED SIZE DEPENDS ON THE DIGITS OF y BEYOND IT       */
+	for(iteration = 0; ; iteration++)
+	{
+		double residual = evaluate_system(b, x), step = 0.0;
+
+		if(residual <= NEWTON_TOLERANCE && iteration > 0)
+			break;
+		if(iteration == NEWTON_MAX_ITERATIONS || isfinite(residual) == 0)
+			return -1.0;
+		if(solve_linear_system(b) == 0)
+			return -1.0;
+		for(i = 0; i < m; i++)
+		{
+			if(fabs(b->rhs[i]) > step)
+				step = fabs(b->rhs[i]);
+		}
+		for(i = 0; i < m; i++)
+		{
+			if(b->rhs[i] < -STEP_TOLERANCE * (b->y[i] + step))
+				return -1.0;
+			b->y[i] += b->rhs[i];
+			if(b->y[i] < 0.0 || isfinite(b->y[i]) == 0)
+				return -1.0;
+		}
+	}
+
+	/*y'(x) = (I - JACOBIAN)^-1 * dx: IT IS POSITIVE BELOW THE RADIUS*/
+	for(i = 0; i < m; i++)
+	{
+		b->rhs[i] = b->dx[i];
+	}
+	if(solve_linear_system(b) == 0 || b->y[s] <= 0.0)
+		return -1.0;
+	for(i = 0; i < m; i++)
+	{
+		if(b->rhs[i] < 0.0 || isfinite(b->rhs[i]) == 0)
+			return -1.0;
+	}
+
+	return x * b->rhs[s] / b->y[s];
+}
+
+
+/*SETS THE RULE PROBABILITIES OF THE GRAMMAR OF ctx SO THAT grow_boltzmann()*/
+/*GENERATES SENTENCES WHOSE EXPECTED NUMBER OF TOKENS IS THE MIDDLE OF THE  */
+/*RANGE OF ctx. THE ALIAS TABLES OF THE RULES (SEE build_alias_table()) ARE */
+/*REPLACED, SO THAT get_random_rle() DRAWS THE RULES AS THE SAMPLER WANTS  */
+void
+tune_boltzmann_sampler(generator_context *ctx)
+{
+	int i, e, m = 0, symbols;
+	double target, lo = 0.0, hi = 1.0, size = -1.0;
+	boltzmann_system b;
+	symbol_list_entry *work_sle = NULL;
+
+	assert(ctx != NULL);
+	assert(ctx->boltzmann_max_size >= 0);
+	work_sle = ctx->symbol_table;
+	assert(work_sle != NULL);
+
+	target = (ctx->boltzmann_min_size + ctx->boltzmann_max_size) / 2.0;
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "tuning the Boltzmann sampler for %g tokens...\n", target);
+
+	memset(&b, 0, sizeof(boltzmann_system));
+	b.symbol_table = work_sle;
+	b.image = work_sle->index->image;
+	assert(b.image != NULL);
+
+	symbols = work_sle->rulecount;
+	b.index = xcalloc(symbols + 1, sizeof(int));
+	for(i = 0; i <= symbols; i++)
+	{
+		b.index[i] = (i > 0 && is_NT(get_symbol(work_sle, i)))? m++ : -1;
+	}
+	b.size = m;
+
+	b.weight = xcalloc(b.image->rule_count + 1, sizeof(double));
+	b.terminals = xcalloc(b.image->rule_count + 1, sizeof(int));
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		rule_list_entry *rle = NULL;
+		double previous = -1.0, least = 0.0;
+
+		if(is_NT(sle) == 0)
+			continue;
+
+		/*THE probability FIELDS ARE CUMULATIVE, AS IN build_alias_table()*/
+		for(rle = sle->rules; rle != NULL; rle = rle->next)
+		{
+			int r = get_rule_index(work_sle, rle), j;
+
+			b.weight[r] = (double) rle->probability - previous;
+			previous = (double) rle->probability;
+			if(b.weight[r] > 0.0 && (least == 0.0 || b.weight[r] < least))
+				least = b.weight[r];
+			for(j = 0; j < rle->length; j++)
+			{
+				if(b.index[rle->rhs[j]] < 0)
+					b.terminals[r]++;
+			}
+		}
+		for(rle = sle->rules; rle != NULL; rle = rle->next)
+		{
+			b.weight[get_rule_index(work_sle, rle)] /= least;
+		}
+	}
+
+	for(i = 0; i < b.image->rule_count; i++)
+	{
+		b.entries += b.image->rules[i].length - b.terminals[i];
+	}
+	b.row = xcalloc(b.entries + 1, sizeof(int));
+	b.column = xcalloc(b.entries + 1, sizeof(int));
+	b.jacobian = xcalloc(b.entries + 1, sizeof(double));
+	for(i = 0, e = 0; i < b.image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(b.image->rules[i]);
+		int j;
+
+		for(j = 0; j < rle->length; j++)
+		{
+			if(b.index[rle->rhs[j]] < 0)
+				continue;
+			b.row[e] = b.index[b.image->rule_lhs[i]];
+			b.column[e++] = b.index[rle->rhs[j]];
+		}
+	}
+	b.y = xcalloc(m, sizeof(double));
+	b.start = xcalloc(m, sizeof(double));
+	b.dx = xcalloc(m, sizeof(double));
+	b.rhs = xcalloc(m, sizeof(double));
+	b.scale = xcalloc(m, sizeof(double));
+	b.work = xcalloc((size_t) 6 * m, sizeof(double));
+
+	/*FIND AN UPPER BOUND, THEN BISECT UNTIL THE EXPECTED SIZE IS CLOSE TO*/
+	/*THE TARGET. THE VALUES AT lo ARE WHERE NEWTON'S METHOD STARTS FROM  */
+	while(hi < MAX_PARAMETER)
+	{
+		size = expected_size(&b, hi, ctx->starting_symbol);
+		if(size < 0.0 || size >= target)
+			break;
+		lo = hi;
+		hi *= 2.0;
+		memcpy(b.start, b.y, m * sizeof(double));
+	}
+	for(i = 0; i < BISECTION_STEPS && hi - lo > lo * 1e-15; i++)
+	{
+		double mid = (lo + hi) / 2.0;
+
+		size = expected_size(&b, mid, ctx->starting_symbol);
+		if(size >= 0.0 && size <= target * (1.0 + BISECTION_TOLERANCE))
+		{
+			lo = mid;
+			memcpy(b.start, b.y, m * sizeof(double));
+		}
+		else
+			hi = mid;
+		if(size >= 0.0 && fabs(size - target) <= target * BISECTION_TOLERANCE)
+			break;
+	}
+	if(lo == 0.0)
+		error(BAD_INPUT, 0, "%s", "the generating functions of the grammar do not converge");
+
+	size = expected_size(&b, lo, ctx->starting_symbol);
+	assert(size >= 0.0);
+	ctx->boltzmann_parameter = lo;
+	if(size < ctx->boltzmann_min_size && must_print_message(WARNING))
+		fprintf(message_stream, "warning: the expected size of the sentences can not exceed %g tokens, most of them will be rejected\n", size);
+
+	/*THE PROBABILITY OF EVERY RULE IS ITS TERM OVER THE VALUE OF IT'S SYMBOL*/
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		rule_list_entry *rle = NULL;
+		double *weight = NULL, total = 0.0;
+		unsigned int *threshold = NULL;
+		int *alias = NULL, n, j;
+
+		if(is_NT(sle) == 0 || sle->rulecount < 2)
+			continue;
+
+		n = sle->rulecount;
+		weight = xcalloc(n, sizeof(double));
+		threshold = xcalloc(n, sizeof(unsigned int));
+		alias = xcalloc(n, sizeof(int));
+		for(j = 0, rle = sle->rules; j < n; j++, rle = rle->next)
+		{
+			int r = get_rule_index(work_sle, rle), k;
+
+			weight[j] = b.weight[r] * pow(lo, b.terminals[r]);
+			for(k = 0; k < rle->length; k++)
+			{
+				if(b.index[rle->rhs[k]] >= 0)
+					weight[j] *= b.y[b.index[rle->rhs[k]]];
+			}
+			total += weight[j];
+		}
+
+		/*SYMBOLS WHICH CAN NOT BE REACHED AT x KEEP THEIR TABLE*/
+		if(total > 0.0)
+		{
+			compute_alias_table(weight, n, threshold, alias);
+			for(j = 0, rle = sle->rules; j < n; j++, rle = rle->next)
+			{
+				rle->alias_threshold = threshold[j];
+				rle->alias = alias[j];
+			}
+		}
+
+		free(weight);
+		free(threshold);
+		free(alias);
+	}
+
+	free(b.index);
+	free(b.weight);
+	free(b.terminals);
+	free(b.row);
+	free(b.column);
+	free(b.jacobian);
+	free(b.y);
+	free(b.start);
+	free(b.dx);
+	free(b.rhs);
+	free(b.scale);
+	free(b.work);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "...done: parameter %g, expected size %g tokens\n", lo, size);
+}
+
+
+/*GENERATES A SENTENCE OF THE GRAMMAR OF ctx WITH THE RULE PROBABILITIES*/
+/*SET BY tune_boltzmann_sampler(), WITH A NUMBER OF TOKENS IN THE RANGE  */
+/*OF ctx. SENTENCES OUT OF THE RANGE ARE REJECTED, AND A NEW ONE IS      */
+/*STARTED AS SOON AS THE TOKENS GENERATED SO FAR, PLUS THE LEAST NUMBER  */
+/*OF TOKENS OF THE SYMBOLS STILL ON THE STACK, EXCEED THE RANGE. THE TEXT*/
+/*IS ONLY WRITTEN ONCE THE SENTENCE IS ACCEPTED. gs IS USED AS IN grow()*/
+void
+grow_boltzmann(generator_context *ctx, generation_state *gs)
+{
+	symbol_list_entry *symbol_table = ctx->symbol_table;
+	stack *st;
+	parse_tree *work_tree;
+	int attempt, i;
+
+	assert(gs != NULL);
+	assert(ctx->starting_symbol != (symbol_id) 0);
+	assert(ctx->boltzmann_max_size >= 0);
+
+	if(must_print_message(GENERATION))
+	{
+		fprintf(message_stream, "called grow_boltzmann for starting symbol\n");
+	}
+
+	st = gs->st;
+	work_tree = gs->pt;
+
+	for(attempt = 0; ; attempt++)
+	{
+		tree_node *current_tree = NULL;
+		symbol_id current = (symbol_id) 0;
+		long size = 0, pending = 0;
+		int rejected = 0;
+
+		if(attempt == BOLTZMANN_MAX_ATTEMPTS)
+			error(BAD_INPUT, 0, "no sentence of %d to %d tokens found in %d attempts", ctx->boltzmann_min_size, ctx->boltzmann_max_size, BOLTZMANN_MAX_ATTEMPTS);
+
+		reset_stack(st);
+		reset_stack(gs->terminals);
+		if(work_tree != NULL)
+		{
+			parse_tree_reset(work_tree, ctx->starting_symbol);
+			current_tree = work_tree->root;
+			current_tree->expanded = 1;
+		}
+
+		push(st, ctx->starting_symbol);
+		pending = symbol_minimal_length(get_symbol(symbol_table, ctx->starting_symbol), symbol_table);
+		current = pop(st);
+
+		while(current != 0)
+		{
+			symbol_list_entry *sle = get_symbol(symbol_table, current);
+
+			assert(sle != NULL);
+			pending -= symbol_minimal_length(sle, symbol_table);
+
+			if(is_NT(sle) == 1)
+			{
+				rule_list_entry *rle = get_random_rle(gs, sle);
+
+				assert(rle != NULL);
+				push_rule_on_stack(st, rle, symbol_table, work_tree, current_tree);
+				pending += rle_minimal_length(rle, symbol_table);
+			}
+			else
+			{
+				push(gs->terminals, current);
+				size++;
+			}
+
+			/*ANTICIPATED REJECTION*/
+			if(size + pending > ctx->boltzmann_max_size)
+			{
+				rejected = 1;
+				break;
+			}
+
+			current = pop(st);
+			if(current_tree != NULL && current != 0)
+			{
+				current_tree = get_current_tree(current_tree);
+				assert(current_tree != NULL);
+				assert(current_tree->sym == current);
+			}
+		}
+
+		if(rejected == 0 && size >= ctx->boltzmann_min_size)
+			break;
+	}
+
+	if(must_print_message(GENERATION))
+	{
+		fprintf(message_stream, "returning from grow_boltzmann, %d sentences rejected\n", attempt);
+	}
+
+	for(i = 0; i < get_size(gs->terminals); i++)
+	{
+		generate_terminal_text(gs, get_symbol(symbol_table, gs->terminals->buffer[i]), symbol_table);
+
+		if(ctx->no_spaces_flag == 0)
+			generate_blank_text(gs);
+	}
+}
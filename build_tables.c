@@ -20,39 +20,43 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 
 #include <generation.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /*OUTPUT STREAMS USED FOR SCANNER ECHOING. DEFINED IN SCANNER SOURCES, BUT REASSIGNED HERE*/
 extern FILE *yyout, *yy_lexiconout;
 
-extern FILE *message_stream, *input_grammar_stream, *input_lexicon_stream, *null_stream;
-
-extern char *input_grammar_file_path;
-extern char *input_lexicon_file_path;
+extern FILE *null_stream;
 
 extern char *yy_lexicontext;
 extern int yy_lexiconlineno;
 
-extern short int input_lexicon_flag;
-extern symbol_id current_symbol_for_lexicon;
-
-extern symbol_id starting_symbol;
-
-extern symbol_list_entry *symbol_table;
+/*THE SCANNERS AND THE PARSER ARE NOT REENTRANT: ONE GRAMMAR IS LOADED AT A TIME*/
+static pthread_mutex_t parsing_lock = PTHREAD_MUTEX_INITIALIZER;
 
-/*BUILD SYMBOL TABLE AND LEXICON DATA STRUCTURES*/
+/*BUILD SYMBOL TABLE AND LEXICON DATA STRUCTURES OF ctx FROM IT'S INPUT STREAMS*/
 void
-build_tables()
+build_tables(generator_context *ctx)
 {
-	int ret_v = 0;
+	int i, ret_v = 0;
 
+	assert(ctx != NULL);
+	assert(ctx->input_grammar_stream != NULL);
+
+	use_generator_context(ctx);
 	if(must_print_message(MAIN))
 		fprintf(message_stream, "building symbol table...\n");
 
-	symbol_table = initialize_new_symbol_list();
-	assert(symbol_table != NULL);
+	pthread_mutex_lock(&parsing_lock);
+	parsing_context = ctx;
+
+	ctx->symbol_table = initialize_new_symbol_list();
+	assert(ctx->symbol_table != NULL);
 	
 	/*SET INPUT STREAM FOR GRAMMAR SCANNER TO USER SPECIFIED GRAMMAR FILE*/
-	yyrestart(input_grammar_stream);
+	yyrestart(ctx->input_grammar_stream);
 	/*REASSIGN OUTPUT STREAM FOR PARSER ECHO ACTIONS (OUTPUT DISCARDED)*/
 	yyout = null_stream;
 
@@ -64,29 +68,45 @@ build_tables()
 		error(BAD_INPUT, 0, "%s", "error in y file");
 
 	/*RUN THE LEXICON FILE SCANNER*/
-	if(input_lexicon_flag != 0)
+	if(ctx->input_lexicon_flag != 0)
 	{
 		if(must_print_message(MAIN))
 			fprintf(message_stream, "scanning input lexical file...\n");
 
-		do_lexicon_scanning();
+		do_lexicon_scanning(ctx);
 
 		if(must_print_message(MAIN))
 			fprintf(message_stream, "done, lexicon table built\n");
 	}
+
+	/*WORD LISTS ARE LOADED AFTER THE LEXICON FILE*/
+	for(i = 0; i < ctx->word_list_count; i++)
+	{
+		load_word_list(ctx, ctx->word_list[i]);
+	}
+	ctx->lexicon_flag = (ctx->input_lexicon_flag != 0 || ctx->word_list_count > 0)? 1:0;
+
+	parsing_context = NULL;
+	pthread_mutex_unlock(&parsing_lock);
 }
 
 
 /*CHECK GRAMMAR CONSISTENCY*/
 void
-check_grammar(symbol_list_entry *work_sle, symbol_id starting_symbol)
+check_grammar(generator_context *ctx)
 {
 	int i;
 	short unsigned max_rules = 0;
 	int check_err_ret_val = 1;
-	symbol_list_entry *s = NULL, *t = NULL;
+	symbol_list_entry *s = NULL, *t = NULL, *work_sle = NULL;
+	symbol_id starting_symbol;
 
+	assert(ctx != NULL);
+	work_sle = ctx->symbol_table;
+	starting_symbol = ctx->starting_symbol;
 	assert(work_sle != NULL);
+
+	use_generator_context(ctx);
 	if(must_print_message(MAIN))
 		fprintf(message_stream, "checking grammar for correctness...\n");
 	s = get_symbol(work_sle, starting_symbol);
@@ -122,35 +142,29 @@ check_grammar(symbol_list_entry *work_sle, symbol_id starting_symbol)
 	/*FROM A SENTENCE GENERATION POINT OF VIEW       */
 	while(check_err_ret_val == 1)
 	{
-		check_err_ret_val = check_error_only(work_sle);
+		check_err_ret_val = check_error_only(work_sle, starting_symbol);
 	}
 	if(must_print_message(MAIN))
 		fprintf(message_stream, "...done\n");	
 
 	/*REMOVE MULTIPLE COPIES OF RULES, AND NORMALIZE probability VALUES*/
-	normalize_rules(symbol_table);
+	normalize_rules(work_sle);
 
-	/*CHECK FOR INFINITE LOOPS IN GRAMMAR DATA STRUCTURE            */
-	/*CICLE THROUGH ALL SYMBOLS AND REPORT IF A LOOP IS FOUND       */
-	/*ALSO COMPUTE THE MAXIMUM OF THE NUMBER OF RULES IN A SYMBOL   */
+	/*CHECK FOR INFINITE LOOPS IN GRAMMAR DATA STRUCTURE: ALL SYMBOLS */
+	/*WHICH CANNOT DERIVE A SENTENCE ARE REPORTED AT ONCE             */
+	if(check_infinite_loops(work_sle) != 0)
+	{
+		error(BAD_INPUT, 0, "%s", "the grammar contains symbols leading to infinite generation");
+	}
+
+	/*COMPUTE THE MAXIMUM OF THE NUMBER OF RULES IN A SYMBOL*/
 	for(i = 1; i <= work_sle->rulecount; i++)
 	{
-		int c = 0;
 		symbol_list_entry *sle_to_check = NULL;
 
-		sle_to_check = get_symbol(symbol_table, i);
-
+		sle_to_check = get_symbol(work_sle, i);
 		assert(sle_to_check != NULL);
 
-		c = check_infinite_loops(sle_to_check);
-
-		if(c == 1)
-		{
-			error(BAD_INPUT, 0,
-			"infinite generation derives from symbol \"%s\"",
-			sle_to_check->name);
-		}
-
 		if(is_NT(sle_to_check) == 1)
 		{
 			if(max_rules < sle_to_check->rulecount)
@@ -172,7 +186,7 @@ check_grammar(symbol_list_entry *work_sle, symbol_id starting_symbol)
 /*CHECKS FOR SYMBOLS USED ONLY FOR ERROR CHECKING (NO RULES)    */
 /*IT RETURNS 0 IF ALL WORK IS DONE, 1 IF IT NEADS TO RUN AGAIN  */
 int
-check_error_only(symbol_list_entry *work_sle)
+check_error_only(symbol_list_entry *work_sle, symbol_id starting_symbol)
 {
 	int i;
 	symbol_list_entry *current_symbol = NULL;
@@ -240,6 +254,7 @@ normalize_rules(symbol_list_entry *work_sle)
 	{
 		int accum = 0, sum = 0, j;
 		symbol_list_entry *current_symbol = NULL;
+		rule_list_entry *current_rule = NULL;
 
 		current_symbol = get_symbol(work_sle, i);
 
@@ -252,81 +267,77 @@ normalize_rules(symbol_list_entry *work_sle)
 
 		/*CHECK FOR TWO RULES WITH THE SAME COMPONENTS. THE ONE WITH THE HIGHEST*/
 		/*POSITION IS REMOVED. THE probability FIELDS WILL BE SUMMED  AND       */
-		/*THE RESULT IS STORED IN THE REMAINING RULE*/
-		for(j = 1; j <= current_symbol->rulecount-1; j++)
+		/*THE RESULT IS STORED IN THE REMAINING RULE                            */
+		/*RULES ARE HASHED IN AN OPEN ADDRESSING TABLE, SO EVERY RULE IS ONLY   */
+		/*COMPARED WITH THE (USUALLY NO) EARLIER RULES HAVING THE SAME HASH     */
 		{
-			rule_list_entry *first = NULL; 
-			int i; 
-
-			first = get_rle(current_symbol, j);
-			assert(first != NULL);
-			
-			for(i=j+1; i <= current_symbol->rulecount; i++)
+			int table_size = 1, pos = 1;
+			rule_list_entry **table_rle = NULL, *prev = NULL;
+			unsigned long *table_hash = NULL;
+			int *table_pos = NULL;
+
+			while(table_size < 2 * current_symbol->rulecount)
+				table_size <<= 1;
+			table_rle = xcalloc(table_size, sizeof(rule_list_entry *));
+			table_hash = xcalloc(table_size, sizeof(unsigned long));
+			table_pos = xcalloc(table_size, sizeof(int));
+
+			current_rule = current_symbol->rules;
+			while(current_rule != NULL)
 			{
-				int equal = 1;
-				rule_list_entry *second = NULL;
-
-				second = get_rle(current_symbol, i);
-				assert(second != NULL);
+				unsigned long h = hash_rle(current_rule);
+				int slot = (int)(h & (unsigned long)(table_size - 1));
+				rule_list_entry *first = NULL;
 
-				if(first->length == second->length)
+				while(table_rle[slot] != NULL)
 				{
-					int h;
-					for(h = 0; h < first->length; h++)
+					if(table_hash[slot] == h && equal_rle(table_rle[slot], current_rule))
 					{
-						symbol_id f = 0, s = 0;
-						f=extract_symbol_rle(first, h);
-						s=extract_symbol_rle(second, h);
-						assert(f != 0);
-						assert(s != 0);
-
-						if(f != s)
-						{
-							equal = 0;
-							break;
-						}	
+						first = table_rle[slot];
+						break;
 					}
-				}
-				else
-				{
-					equal = 0;
+					slot = (slot + 1) & (table_size - 1);
 				}
 
 				/*FOUND TWO IDENTICAL RULES*/
-				if(equal == 1)
+				if(first != NULL)
 				{
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: found two identical rules (probabilities have been merged) in symbol: \"%s\", rules %d and %d\n", current_symbol->name, j, i);
+						fprintf(message_stream, "warning: found two identical rules (probabilities have been merged) in symbol: \"%s\", rules %d and %d\n", current_symbol->name, table_pos[slot], pos);
 
-					first->probability += second->probability;
-					remove_rle(current_symbol, i);
-					i--;
+					first->probability += current_rule->probability;
+					current_rule = current_rule->next;
+					remove_next_rle(current_symbol, prev);
 				}
 				else
-					continue;
+				{
+					table_rle[slot] = current_rule;
+					table_hash[slot] = h;
+					table_pos[slot] = pos++;
+					prev = current_rule;
+					current_rule = current_rule->next;
+				}
 			}
+
+			free(table_rle);
+			free(table_hash);
+			free(table_pos);
 		}
 
 		/*SUM UP THE VALUES DEFINED IN GRAMMAR INPUT FILE (OR DEFAULTS)*/
-		for(j=1; j <= current_symbol->rulecount; j++)
+		/*THE RULE LIST IS WALKED DIRECTLY: get_rle() WOULD MAKE THIS QUADRATIC*/
+		for(current_rule = current_symbol->rules; current_rule != NULL; current_rule = current_rule->next)
 		{
-			rule_list_entry	*current_rule=NULL;
-
-			current_rule = get_rle(current_symbol, j);
-			assert(current_rule != NULL);
-
 			assert(current_rule->probability >= 0);
 
 			sum += current_rule->probability;
 		}
 
 		/*NORMALIZE AGAINST INT_MAX */
-		for(j=1; j <= current_symbol->rulecount; j++)
+		for(j=1, current_rule = current_symbol->rules; j <= current_symbol->rulecount; j++, current_rule = current_rule->next)
 		{
-			rule_list_entry	*current_rule=NULL;
 			float share = 0.0;
 
-			current_rule = get_rle(current_symbol, j);
 			assert(current_rule != NULL);
 			assert(sum != 0);
 
@@ -341,9 +352,12 @@ normalize_rules(symbol_list_entry *work_sle)
 			
 			/*TAKE ADVANTAGE OF THIS CICLE ALSO TO CHARACTERIZE THE RULE TYPE*/
 			{
-				current_rule->type = determine_rule_type(current_symbol->id, current_rule, symbol_table);
+				current_rule->type = determine_rule_type(current_symbol->id, current_rule, work_sle);
 			}
 		}
+
+		/*PROBABILITIES ARE FINAL: BUILD THE TABLE USED BY get_random_rle()*/
+		build_alias_table(current_symbol);
 	}
 
 	if(must_print_message(MAIN))
@@ -351,91 +365,296 @@ normalize_rules(symbol_list_entry *work_sle)
 }
 
 
-/*CHECK FOR UNTERMINATING LOOPS OF NON_TERMINALS IN RULES                */
-/*NOT CHECKING FOR THESE CONDITIONS IN TARGET GRAMMAR                    */
-/*WOULD LEED TO SEGMENTATION FAULT DUE TO INFINITE RECURSION OF "grow()" */
-/*IF FOUND RETURN 1, ELSE RETURN 0                                       */
-int
-check_infinite_loops(symbol_list_entry *sle)
+/*BUILDS THE ALIAS TABLE (WALKER'S METHOD, IN VOSE'S FORMULATION) OF n    */
+/*CHOICES WITH THE GIVEN (POSITIVE) weight. EVERY CHOICE GETS AN EQUAL     */
+/*SHARE OF THE RANDOM VALUES, KEEPS threshold[i] OF IT (OVER              */
+/*ALIAS_THRESHOLD_ONE) AND GIVES THE REST TO ONE OTHER CHOICE (alias[i]),  */
+/*SO THAT A CHOICE CAN BE DRAWN WITH TWO RANDOM NUMBERS WHATEVER n IS.     */
+/*weight IS USED AS SCRATCH SPACE                                          */
+void
+compute_alias_table(double *weight, int n, unsigned int *threshold, int *alias)
 {
-	int i;
+	int i, small_size = 0, large_size = 0;
+	double total = 0.0;
+	int *small = NULL, *large = NULL;
 
-	assert(sle != NULL);
-	assert(sle->id > 0);
+	assert(weight != NULL);
+	assert(n > 0);
 
-	/*MARK THE SYMBOL (FOR SIMULATING "PRESENCE IN THE STACK" CHECKING)*/
-	/*THE FUNCTION WILL UNMARK THE SYMBOL WHEN IT RETURNS              */
-	sle->visited = 1;
+	small = xcalloc(n, sizeof(int));
+	large = xcalloc(n, sizeof(int));
 
-	/*IF SYMBOL IS NOT A NON-TERMINAL, IT TRIVIALLY DOES NOT LEAD TO CYCLES*/
-	if(is_NT(sle) == 0)
+	for(i = 0; i < n; i++)
 	{
-		sle->visited = 0;
-		return 0;
+		total += weight[i];
 	}
 
-	/*CYCLE THROUGH RULES. IF THE SYMBOL CONTAINS EVEN ONE "ONLY-TERMINAL" RULE, */
-	/*IT CANNOT BE HELD RESPONSIBLE FOR LOOPS. FOR THIS REASON WE MUST REITERATE */
-	/*THE ALGORITHM FOR EVERY SYMBOL ( IN check_grammar() )                      */
-	/*IF A RULE CONTAINS NON-TERMINALS, THEY MUST BE CHECKED RECURSIVELY         */
-	for(i = 1 ; i <= sle->rulecount; i++)
+	/*SCALE WEIGHTS SO THAT THEIR AVERAGE IS ONE, AND SPLIT THEM BY SIZE*/
+	for(i = 0; i < n; i++)
 	{
-		rule_list_entry *rle = NULL;		
+		weight[i] = weight[i] * (double) n / total;
+		if(weight[i] < 1.0)
+			small[small_size++] = i;
+		else
+			large[large_size++] = i;
+	}
+
+	/*EVERY SMALL CHOICE IS TOPPED UP BY A LARGE ONE, WHICH MAY BECOME SMALL*/
+	while(small_size > 0 && large_size > 0)
+	{
+		int s = small[--small_size];
+		int l = large[--large_size];
 
-		rle = get_rle(sle, i);
+		threshold[s] = (unsigned int)(weight[s] * (double) ALIAS_THRESHOLD_ONE);
+		alias[s] = l;
+
+		weight[l] = (weight[l] + weight[s]) - 1.0;
+		if(weight[l] < 1.0)
+			small[small_size++] = l;
+		else
+			large[large_size++] = l;
+	}
+
+	/*WHAT IS LEFT IS ONE, UP TO ROUNDING ERRORS*/
+	while(large_size > 0)
+	{
+		int l = large[--large_size];
+
+		threshold[l] = ALIAS_THRESHOLD_ONE;
+		alias[l] = l;
+	}
+	while(small_size > 0)
+	{
+		int s = small[--small_size];
+
+		threshold[s] = ALIAS_THRESHOLD_ONE;
+		alias[s] = s;
+	}
+
+	free(small);
+	free(large);
+}
+
+
+/*BUILDS THE ALIAS TABLE OF NT SYMBOL sle, WHOSE probability FIELDS HOLD*/
+/*THE CUMULATIVE DISTRIBUTION SET UP BY normalize_rules(). THE TABLE IS */
+/*STORED IN THE alias_threshold AND alias FIELDS OF THE RULES, AND THE  */
+/*DISTRIBUTION IS THE SAME AS BEFORE                                    */
+void
+build_alias_table(symbol_list_entry *sle)
+{
+	int n, i;
+	double previous = -1.0;
+	double *weight = NULL;
+	unsigned int *threshold = NULL;
+	int *alias = NULL;
+	rule_list_entry *rle = NULL;
+
+	assert(sle != NULL);
+	assert(is_NT(sle) == 1);
+	assert(sle->rulecount > 0);
+
+	n = sle->rulecount;
+	weight = xcalloc(n, sizeof(double));
+	threshold = xcalloc(n, sizeof(unsigned int));
+	alias = xcalloc(n, sizeof(int));
+
+	/*RULE i IS DRAWN BY get_random_rle() FOR RANDOM VALUES IN (p[i-1], p[i]]*/
+	for(i = 0, rle = sle->rules; i < n; i++, rle = rle->next)
+	{
 		assert(rle != NULL);
+		weight[i] = (double) rle->probability - previous;
+		previous = (double) rle->probability;
+	}
+
+	compute_alias_table(weight, n, threshold, alias);
+
+	for(i = 0, rle = sle->rules; i < n; i++, rle = rle->next)
+	{
+		rle->alias_threshold = threshold[i];
+		rle->alias = alias[i];
+	}
+
+	free(weight);
+	free(threshold);
+	free(alias);
+}
+
+
+/*BUILDS THE ALIAS TABLE OF THE WEIGHTED LEXICON lex, USED BY       */
+/*generate_terminal_text() TO DRAW UNITS IN PROPORTION TO THEIR WEIGHT*/
+void
+build_lexicon_alias_table(lexicon_structure *lex)
+{
+	int i;
+	double *weight = NULL;
+
+	assert(lex != NULL);
+	assert(lex->unit_weight != NULL);
+	assert(lex->unit_count > 0);
+
+	weight = xcalloc(lex->unit_count, sizeof(double));
+	for(i = 0; i < lex->unit_count; i++)
+	{
+		weight[i] = (double) lex->unit_weight[i];
+	}
+
+	free(lex->alias_threshold);
+	free(lex->alias);
+	lex->alias_threshold = xcalloc(lex->unit_count, sizeof(unsigned int));
+	lex->alias = xcalloc(lex->unit_count, sizeof(int));
+	compute_alias_table(weight, lex->unit_count, lex->alias_threshold, lex->alias);
+
+	free(weight);
+}
+
+
+/*CHECK FOR UNTERMINATING LOOPS OF NON_TERMINALS IN RULES                */
+/*NOT CHECKING FOR THESE CONDITIONS IN TARGET GRAMMAR                    */
+/*WOULD LEED TO ENDLESS GENERATION IN "grow()" AND "purdom()"            */
+/*A SYMBOL IS PRODUCTIVE IF ONE OF IT'S RULES CONTAINS ONLY PRODUCTIVE   */
+/*SYMBOLS (TERMINALS TRIVIALLY ARE). PRODUCTIVE SYMBOLS ARE FOUND WITH A */
+/*WORKLIST: A RULE COUNTS IT'S NON-TERMINALS NOT YET KNOWN TO BE         */
+/*PRODUCTIVE, AND MAKES IT'S LEFT-HAND SIDE PRODUCTIVE WHEN IT REACHES 0 */
+/*EVERY SYMBOL IN EVERY RULE IS EXAMINED ONCE, SO THE CHECK IS LINEAR    */
+/*IN THE SIZE OF THE GRAMMAR. ALL NON-PRODUCTIVE SYMBOLS ARE REPORTED    */
+/*RETURNS THE NUMBER OF NON-PRODUCTIVE SYMBOLS FOUND                     */
+int
+check_infinite_loops(symbol_list_entry *work_sle)
+{
+	int i, rule_count = 0, occ_count = 0, worklist_size = 0, found = 0;
+	int symbols;
+	int *pending = NULL, *occ_offset = NULL, *occ_rule = NULL;
+	symbol_id *rule_lhs = NULL, *worklist = NULL;
+	char *productive = NULL;
+
+	assert(work_sle != NULL);
+
+	symbols = work_sle->rulecount;
+	occ_offset = xcalloc(symbols + 2, sizeof(int));
+	productive = xcalloc(symbols + 1, sizeof(char));
+	worklist = xcalloc(symbols + 1, sizeof(symbol_id));
+
+	/*FIRST PASS: NUMBER THE RULES AND COUNT NON-TERMINAL OCCURRENCES*/
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		rule_list_entry *rle = NULL;
 
-		/*LITTLE PERFORMANCE HACK. EXPLOITS THE FACT THAT */
-		/*RULE TYPE HAS ALREADY BEEN DETERMINED           */
-		if(is_ONLY_TERMINALS(rle))
+		assert(sle != NULL);
+		if(is_NT(sle) == 0)
 		{
-			sle->visited = 0;
-			return 0;
+			productive[i] = 1;
+			continue;
 		}
-		/*MAIN ALGORITHM FOR RULE CHECKING.                                */
-		/*IF THE RULE CONTAINS A SYMBOL ALREADY MARKED, IT MEANS RECURSION.*/
-		/*THE RULE IS DANGEROUS                                            */
-		/*IF THE RULE CONTAINS ONLY SYMBOLS NOT ALREADY MARKED, THE RULE IS*/
-		/*MARKED AS DANGEROUS IF EVEN ONE OF THEM LEADS TO A LOOP          */
+
+		for(rle = sle->rules; rle != NULL; rle = rle->next)
 		{
-			int j, dangerous = 0;
+			int j;
 
+			rule_count++;
 			for(j = 0; j < rle->length; j++)
 			{
-				symbol_id s = 0;
-				symbol_list_entry *sle = NULL;
+				symbol_id s = extract_symbol_rle(rle, j);
+				symbol_list_entry *t = get_symbol(work_sle, s);
+
+				assert(t != NULL);
+				if(is_NT(t) == 1)
+				{
+					occ_offset[s + 1]++;
+					occ_count++;
+				}
+			}
+		}
+	}
+	for(i = 1; i <= symbols + 1; i++)
+	{
+		occ_offset[i] += occ_offset[i - 1];
+	}
+
+	pending = xcalloc(rule_count + 1, sizeof(int));
+	rule_lhs = xcalloc(rule_count + 1, sizeof(symbol_id));
+	occ_rule = xcalloc(occ_count + 1, sizeof(int));
+
+	/*SECOND PASS: LINK EVERY NON-TERMINAL TO THE RULES USING IT, AND SEED*/
+	/*THE WORKLIST WITH THE LEFT-HAND SIDES OF ONLY-TERMINAL RULES        */
+	rule_count = 0;
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		rule_list_entry *rle = NULL;
+
+		if(is_NT(sle) == 0)
+		{
+			continue;
+		}
+
+		for(rle = sle->rules; rle != NULL; rle = rle->next, rule_count++)
+		{
+			int j;
 
-				s = extract_symbol_rle(rle, j);
-				assert(s != 0);
-				sle = get_symbol(symbol_table, s);
-				assert(sle != NULL);
+			rule_lhs[rule_count] = sle->id;
+			for(j = 0; j < rle->length; j++)
+			{
+				symbol_id s = extract_symbol_rle(rle, j);
 
-				if(is_NT(sle) == 1)
+				/*ALL THE OCCURRENCES COUNTED BY THE FIRST PASS ARE STORED: THE*/
+				/*SYMBOLS SEEDED SO FAR WILL BE PROPAGATED AS ALL OTHERS       */
+				if(is_NT(get_symbol(work_sle, s)) == 1)
 				{
-					if(sle->visited == 0)
-					{
-						dangerous = 
-						(dangerous || check_infinite_loops(sle));
-					}
-					else
-					{
-						dangerous = 1;
-					}
+					/*occ_offset[s] IS USED AS A FILL POINTER AND RESTORED BELOW*/
+					occ_rule[occ_offset[s]++] = rule_count;
+					pending[rule_count]++;
 				}
 			}
-			/*IF THE RULE IS NOT MARKED AS DANGEROUS, THEN IT DERIVES SYMBOLS*/
-			/*WICH LEAD TO TERMINALS. THE SYMBOL DOES NOT LEAD TO AN INF LOOP*/
-			if(dangerous == 0)
+			if(pending[rule_count] == 0 && productive[i] == 0)
 			{
-				sle->visited = 0;
-				return 0;
+				productive[i] = 1;
+				worklist[worklist_size++] = sle->id;
 			}
 		}
 	}
-	
-	/*IF THE FUNCTION HAS NOT ALREADY RETURNED, THEN THE SYMBOL DOES LEAD TO AN INF LOOP*/
-	sle->visited = 0;
-	return 1;
+	for(i = symbols + 1; i > 0; i--)
+	{
+		occ_offset[i] = occ_offset[i - 1];
+	}
+	occ_offset[0] = 0;
+
+	/*PROPAGATE PRODUCTIVITY TO THE RULES USING EVERY NEW PRODUCTIVE SYMBOL*/
+	while(worklist_size > 0)
+	{
+		symbol_id s = worklist[--worklist_size];
+		int j;
+
+		for(j = occ_offset[s]; j < occ_offset[s + 1]; j++)
+		{
+			int r = occ_rule[j];
+
+			if(--pending[r] == 0 && productive[rule_lhs[r]] == 0)
+			{
+				productive[rule_lhs[r]] = 1;
+				worklist[worklist_size++] = rule_lhs[r];
+			}
+		}
+	}
+
+	for(i = 1; i <= symbols; i++)
+	{
+		if(productive[i] == 0)
+		{
+			error(0, 0, "infinite generation derives from symbol \"%s\"", get_symbol(work_sle, i)->name);
+			found++;
+		}
+	}
+
+	free(pending);
+	free(occ_offset);
+	free(occ_rule);
+	free(rule_lhs);
+	free(worklist);
+	free(productive);
+
+	return found;
 }
 
 
@@ -474,12 +693,394 @@ void epure_symbol(symbol_list_entry *sle, symbol_list_entry *symbol_table)
 }
 
 
+/*BUILDS THE READ-ONLY GRAMMAR IMAGE: THE RIGHT-HAND SIDES OF ALL RULES ARE   */
+/*COPIED BACK TO BACK IN A SINGLE symbol_id ARRAY, AND THE RULES OF EVERY     */
+/*NON-TERMINAL ARE MOVED IN A CONTIGUOUS BLOCK OF A SINGLE rule_list_entry    */
+/*ARRAY. AFTER THIS CALL get_rle() AND extract_symbol_rle() ARE SIMPLE LOADS, */
+/*AND THE RULES OF THE GRAMMAR CAN NO LONGER BE MODIFIED                      */
+/*MUST BE CALLED ONCE, AFTER check_grammar()                                  */
+void
+compile_grammar(symbol_list_entry *work_sle)
+{
+	int i, rule_pos = 0, rhs_pos = 0;
+	grammar_image *image = NULL;
+
+	assert(work_sle != NULL);
+	assert(work_sle->index != NULL);
+	assert(work_sle->index->image == NULL);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "compiling grammar image...\n");
+
+	image = xcalloc(1, sizeof(grammar_image));
+	image->rule_offset = xcalloc(work_sle->rulecount + 1, sizeof(int));
+	image->rule_num = xcalloc(work_sle->rulecount + 1, sizeof(int));
+	image->min_length = xcalloc(work_sle->rulecount + 1, sizeof(int));
+
+	/*FIRST PASS: SIZE THE ARRAYS*/
+	for(i = 1; i <= work_sle->rulecount; i++)
+	{
+		symbol_list_entry *sle = NULL;
+		rule_list_entry *rle = NULL;
+
+		sle = get_symbol(work_sle, i);
+		assert(sle != NULL);
+
+		if(is_NT(sle) == 0)
+		{
+			continue;
+		}
+
+		for(rle = sle->rules; rle != NULL; rle = rle->next)
+		{
+			image->rule_count++;
+			image->rhs_size += rle->length;
+		}
+	}
+
+	/*ALLOCATE AT LEAST ONE ELEMENT, SO THAT rhs POINTERS ARE NEVER NULL*/
+	image->rhs = xcalloc(image->rhs_size + 1, sizeof(symbol_id));
+	image->rules = xcalloc(image->rule_count + 1, sizeof(rule_list_entry));
+	image->rule_lhs = xcalloc(image->rule_count + 1, sizeof(symbol_id));
+	image->rule_min_length = xcalloc(image->rule_count + 1, sizeof(int));
+
+	/*SECOND PASS: MOVE RULES AND SYMBOLS IN THE IMAGE*/
+	for(i = 1; i <= work_sle->rulecount; i++)
+	{
+		symbol_list_entry *sle = NULL;
+		rule_list_entry *rle = NULL;
+		int first = rule_pos;
+
+		sle = get_symbol(work_sle, i);
+		assert(sle != NULL);
+
+		if(is_NT(sle) == 0)
+		{
+			continue;
+		}
+
+		image->rule_offset[i] = rule_pos;
+		image->rule_num[i] = sle->rulecount;
+
+		rle = sle->rules;
+		while(rle != NULL)
+		{
+			rule_list_entry *next = rle->next;
+			rule_list_entry *dest = &(image->rules[rule_pos]);
+			int j;
+
+			for(j = 0; j < rle->length; j++)
+			{
+				image->rhs[rhs_pos + j] = extract_symbol_rle(rle, j);
+			}
+
+			*dest = *rle;
+			image->rule_lhs[rule_pos] = sle->id;
+			dest->rhs = &(image->rhs[rhs_pos]);
+			dest->rule = NULL;
+			dest->next = NULL;
+			if(rule_pos > first)
+			{
+				image->rules[rule_pos - 1].next = dest;
+			}
+			if(sle->shortest == rle)
+			{
+				sle->shortest = dest;
+			}
+
+			rhs_pos += rle->length;
+			rule_pos++;
+
+			clean_rule(rle->rule);
+			free(rle);
+			rle = next;
+		}
+		assert(rule_pos - first == sle->rulecount);
+
+		sle->rules = (sle->rulecount > 0)? &(image->rules[first]) : NULL;
+	}
+	assert(rule_pos == image->rule_count);
+	assert(rhs_pos == image->rhs_size);
+
+	work_sle->index->image = image;
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "...done: %d rules, %d symbols in right-hand sides\n", image->rule_count, image->rhs_size);
+
+	compute_minimal_lengths(work_sle);
+	compile_terminal_text(work_sle);
+
+	/*WEIGHTED LEXICONS ARE SAMPLED THROUGH AN ALIAS TABLE*/
+	for(i = 1; i <= work_sle->rulecount; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		if(is_LEXICAL(sle) && get_lexicon_numerosity(sle) > 0 && ((lexicon_structure *) sle->rules)->unit_weight != NULL)
+			build_lexicon_alias_table((lexicon_structure *) sle->rules);
+	}
+}
+
+
+/*DECODES ONCE THE ESCAPE SEQUENCES IN THE NAMES OF THE TERMINALS WHICH */
+/*ARE PRINTED BY NAME (LITERALS AND LEXICALS WITHOUT LEXICON), SO THAT  */
+/*GENERATION ONLY COPIES THEIR BYTES. THE DECODED NAMES ARE STORED BACK */
+/*TO BACK IN THE text FIELD OF THE GRAMMAR IMAGE                        */
+void
+compile_terminal_text(symbol_list_entry *work_sle)
+{
+	int i;
+	size_t size = 0, used = 0;
+	grammar_image *image = NULL;
+
+	assert(work_sle != NULL);
+	image = work_sle->index->image;
+	assert(image != NULL);
+
+	image->text_offset = xmalloc((work_sle->rulecount + 1) * sizeof(int));
+	image->text_length = xcalloc(work_sle->rulecount + 1, sizeof(int));
+	image->text_offset[0] = -1;
+
+	/*DECODING NEVER MAKES A NAME LONGER*/
+	for(i = 1; i <= work_sle->rulecount; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		assert(sle != NULL);
+		if(is_LITERAL(sle) || (is_LEXICAL(sle) && get_lexicon_numerosity(sle) == 0))
+			size += strlen(sle->name);
+	}
+	image->text = xmalloc(size + 1);
+
+	for(i = 1; i <= work_sle->rulecount; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		if(is_LITERAL(sle) || (is_LEXICAL(sle) && get_lexicon_numerosity(sle) == 0))
+		{
+			image->text_offset[i] = (int) used;
+			image->text_length[i] = (int) decode_escapes(sle->name, image->text + used);
+			used += image->text_length[i];
+		}
+		else
+		{
+			image->text_offset[i] = -1;
+		}
+	}
+	assert(used <= size);
+}
+
+
+/*ORDERS QUEUE ENTRIES BY LENGTH, THEN BY RULE POSITION, SO THAT AMONG */
+/*RULES OF EQUAL LENGTH THE FIRST ONE IN THE GRAMMAR IS PREFERRED      */
+static int
+min_length_queue_less(min_length_queue_entry *a, min_length_queue_entry *b)
+{
+	if(a->length != b->length)
+		return a->length < b->length;
+	return a->rule < b->rule;
+}
+
+void
+min_length_queue_push(min_length_queue_entry *q, int *size, int length, int rule)
+{
+	int i = (*size)++;
+
+	/*SIFT THE NEW ENTRY UP*/
+	while(i > 0)
+	{
+		int parent = (i - 1) / 2;
+		min_length_queue_entry e;
+
+		e.length = length;
+		e.rule = rule;
+		if(!min_length_queue_less(&e, &(q[parent])))
+			break;
+		q[i] = q[parent];
+		i = parent;
+	}
+	q[i].length = length;
+	q[i].rule = rule;
+}
+
+min_length_queue_entry
+min_length_queue_pop(min_length_queue_entry *q, int *size)
+{
+	min_length_queue_entry top = q[0], last;
+	int i = 0;
+
+	assert(*size > 0);
+	last = q[--(*size)];
+
+	/*SIFT THE LAST ENTRY DOWN FROM THE ROOT*/
+	while(2 * i + 1 < *size)
+	{
+		int child = 2 * i + 1;
+
+		if(child + 1 < *size && min_length_queue_less(&(q[child + 1]), &(q[child])))
+			child++;
+		if(!min_length_queue_less(&(q[child]), &last))
+			break;
+		q[i] = q[child];
+		i = child;
+	}
+	if(*size > 0)
+		q[i] = last;
+
+	return top;
+}
+
+/*SATURATING ADDITION, LENGTHS OF HUGE GRAMMARS MUST NOT WRAP AROUND*/
+int
+min_length_add(int a, int b)
+{
+	return (a > INT_MAX - b)? INT_MAX : a + b;
+}
+
+
+/*COMPUTES, FOR EVERY SYMBOL AND RULE OF THE COMPILED GRAMMAR, THE MINIMAL  */
+/*NUMBER OF LEXICAL UNITS OF A SENTENCE DERIVING FROM IT, AND STORES THE    */
+/*RULE REACHING THAT MINIMUM IN THE shortest FIELD OF EVERY NON-TERMINAL    */
+/*THIS IS KNUTH'S GENERALIZATION OF DIJKSTRA'S ALGORITHM: A RULE BECOMES A  */
+/*CANDIDATE ONCE ALL NON-TERMINALS IN IT HAVE A FINAL LENGTH, AND THE       */
+/*SHORTEST CANDIDATE FINALIZES ITS LEFT-HAND SIDE. EVERY RULE IS QUEUED ONCE*/
+/*SO THE WHOLE PASS IS O(G log G) IN THE SIZE OF THE GRAMMAR                */
+/*NON-PRODUCTIVE SYMBOLS (IF ANY) ARE LEFT WITH LENGTH INT_MAX              */
+void
+compute_minimal_lengths(symbol_list_entry *work_sle)
+{
+	int i, queue_size = 0, symbols;
+	int *pending = NULL, *occ_offset = NULL, *occ_rule = NULL;
+	min_length_queue_entry *queue = NULL;
+	grammar_image *image = NULL;
+
+	assert(work_sle != NULL);
+	assert(work_sle->index != NULL);
+	image = work_sle->index->image;
+	assert(image != NULL);
+
+	symbols = work_sle->rulecount;
+
+	/*pending[r] COUNTS THE NON-TERMINALS OF RULE r WITHOUT A FINAL LENGTH*/
+	/*occ_rule[occ_offset[s]...occ_offset[s+1]-1] ARE THE RULES USING s   */
+	pending = xcalloc(image->rule_count + 1, sizeof(int));
+	occ_offset = xcalloc(symbols + 2, sizeof(int));
+	occ_rule = xcalloc(image->rhs_size + 1, sizeof(int));
+	queue = xcalloc(image->rule_count + 1, sizeof(min_length_queue_entry));
+
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		assert(sle != NULL);
+		image->min_length[i] = (is_NT(sle) == 1)? INT_MAX : 1;
+		sle->shortest = NULL;
+	}
+
+	/*COUNT THE NON-TERMINAL OCCURRENCES, AND SUM UP THE TERMINAL ONES*/
+	for(i = 0; i < image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(image->rules[i]);
+		int j;
+
+		for(j = 0; j < rle->length; j++)
+		{
+			symbol_id s = rle->rhs[j];
+
+			if(image->min_length[s] == INT_MAX)
+			{
+				pending[i]++;
+				occ_offset[s + 1]++;
+			}
+			else
+			{
+				image->rule_min_length[i] = min_length_add(image->rule_min_length[i], 1);
+			}
+		}
+	}
+	for(i = 1; i <= symbols + 1; i++)
+	{
+		occ_offset[i] += occ_offset[i - 1];
+	}
+	for(i = 0; i < image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(image->rules[i]);
+		int j;
+
+		for(j = 0; j < rle->length; j++)
+		{
+			symbol_id s = rle->rhs[j];
+
+			if(image->min_length[s] == INT_MAX)
+			{
+				/*occ_offset[s] IS USED AS A FILL POINTER AND RESTORED BELOW*/
+				occ_rule[occ_offset[s]++] = i;
+			}
+		}
+		if(pending[i] == 0)
+		{
+			min_length_queue_push(queue, &queue_size, image->rule_min_length[i], i);
+		}
+	}
+	for(i = symbols + 1; i > 0; i--)
+	{
+		occ_offset[i] = occ_offset[i - 1];
+	}
+	occ_offset[0] = 0;
+
+	while(queue_size > 0)
+	{
+		min_length_queue_entry e = min_length_queue_pop(queue, &queue_size);
+		symbol_id lhs = image->rule_lhs[e.rule];
+		symbol_list_entry *sle = NULL;
+		int j;
+
+		/*THE LEFT-HAND SIDE ALREADY HAS A SHORTER (OR EARLIER) RULE*/
+		if(image->min_length[lhs] != INT_MAX)
+			continue;
+
+		sle = get_symbol(work_sle, lhs);
+		assert(sle != NULL);
+		image->min_length[lhs] = e.length;
+		sle->shortest = &(image->rules[e.rule]);
+
+		/*PROPAGATE THE FINAL LENGTH TO ALL THE RULES USING lhs*/
+		for(j = occ_offset[lhs]; j < occ_offset[lhs + 1]; j++)
+		{
+			int r = occ_rule[j];
+
+			image->rule_min_length[r] = min_length_add(image->rule_min_length[r], e.length);
+			if(--pending[r] == 0)
+			{
+				min_length_queue_push(queue, &queue_size, image->rule_min_length[r], r);
+			}
+		}
+	}
+
+	/*RULES USING NON-PRODUCTIVE SYMBOLS NEVER END*/
+	for(i = 0; i < image->rule_count; i++)
+	{
+		if(pending[i] != 0)
+			image->rule_min_length[i] = INT_MAX;
+	}
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "minimal derivation lengths computed for %d symbols\n", symbols);
+
+	free(pending);
+	free(occ_offset);
+	free(occ_rule);
+	free(queue);
+}
+
+
 /*MANAGE THE PARSING OF THE LEXICON FILE BY CYCLING SCANNER FUNCTION 'yy_lexiconlex()'*/
 /*THERE IS NO NEED FOR A BISON SCANNER FOR THIS FUNCTIONALITY                         */
 void
-do_lexicon_scanning()
+do_lexicon_scanning(generator_context *ctx)
 {
-	yy_lexiconrestart(input_lexicon_stream);
+	assert(ctx != NULL);
+
+	yy_lexiconrestart(ctx->input_lexicon_stream);
 	/*REASSIGN OUTPUT STREAM FOR PARSER ECHO ACTIONS (OUTPUT DISCARDED)*/
 	yy_lexiconout = null_stream;
 
@@ -499,27 +1100,27 @@ do_lexicon_scanning()
 			{
 				case UNEXPECTED_IDENTIFIER:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: unexpected identifier, scanning stopped: %s\n", input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
+						fprintf(message_stream, "warning: %s: line %d: unexpected identifier, scanning stopped: %s\n", ctx->input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
 					return;
 				case UNEXPECTED_SEMICOLON:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: unexpected semicolon, scanning stopped: %s\n", input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
+						fprintf(message_stream, "warning: %s: line %d: unexpected semicolon, scanning stopped: %s\n", ctx->input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
 					return;
 				case UNEXPECTED_LEXICAL_UNIT:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: unexpected lexical unit, scanning stopped: %s\n", input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
+						fprintf(message_stream, "warning: %s: line %d: unexpected lexical unit, scanning stopped: %s\n", ctx->input_lexicon_file_path, yy_lexiconlineno, yy_lexicontext);
 					return;
 				case UNEXPECTED_EOF:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: unexpected EOF, scanning stopped\n", input_lexicon_file_path, yy_lexiconlineno);
+						fprintf(message_stream, "warning: %s: line %d: unexpected EOF, scanning stopped\n", ctx->input_lexicon_file_path, yy_lexiconlineno);
 					return;
 				case EMPTY_STRING_LITERAL:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: found empty string literal, scanning stopped\n", input_lexicon_file_path, yy_lexiconlineno);
+						fprintf(message_stream, "warning: %s: line %d: found empty string literal, scanning stopped\n", ctx->input_lexicon_file_path, yy_lexiconlineno);
 					return;
 				case UNEXPECTED_CHARACTER:
 					if(must_print_message(WARNING))
-						fprintf(message_stream, "warning: %s: line %d: found unexpected character, scanning stopped\n", input_lexicon_file_path, yy_lexiconlineno);
+						fprintf(message_stream, "warning: %s: line %d: found unexpected character, scanning stopped\n", ctx->input_lexicon_file_path, yy_lexiconlineno);
 					return;
 				default:
 					/*NOTHING ELSE SHOULD BE RETURNED BY SCANNER*/
@@ -529,9 +1130,27 @@ do_lexicon_scanning()
 		}
 		else if(i == ASSOCIATED_LEXICAL_UNIT)
 		{
-			if((int)current_symbol_for_lexicon > 0)
+			unsigned long weight;
+
+			if((int)ctx->current_symbol_for_lexicon > 0)
+			{
+				add_lexical_unit(ctx, ctx->current_symbol_for_lexicon);
+			}
+
+			/*THE UNIT IS COPIED ALREADY, SO THE SCANNER CAN READ ON*/
+			weight = read_lexicon_weight();
+			if(weight == 0)
 			{
-				add_lexical_unit(current_symbol_for_lexicon);
+				if(must_print_message(WARNING))
+					fprintf(message_stream, "warning: %s: line %d: bad weight for lexical unit (must be between 1 and %lu), scanning stopped\n", ctx->input_lexicon_file_path, yy_lexiconlineno, MAX_LEXICON_WEIGHT);
+				return;
+			}
+			if(weight != 1 && (int)ctx->current_symbol_for_lexicon > 0)
+			{
+				symbol_list_entry *sle = get_symbol(ctx->symbol_table, ctx->current_symbol_for_lexicon);
+				lexicon_structure *lex = (lexicon_structure *) sle->rules;
+
+				set_lexicon_unit_weight(lex, lex->unit_count - 1, (unsigned int) weight);
 			}
 		}
 		else
@@ -543,18 +1162,124 @@ do_lexicon_scanning()
 }
 
 
-/*ADD A LEXICAL UNIT TO THE argz STRUCTURE FOR TERMINAL SYMBOLS */
+/*LOADS A WORD LIST, GIVEN AS "TOKEN:FILE": EVERY LINE OF FILE IS A LEXICAL */
+/*UNIT OF TOKEN, TAKEN AS IT IS (NO ESCAPE SEQUENCES, NO WEIGHTS). THE FILE */
+/*IS MAPPED IN MEMORY AND ONLY THE START OF EVERY LINE IS STORED, SO THE   */
+/*TEXT IS NEVER COPIED AND IS SHARED THROUGH THE PAGE CACHE BY ALL THE      */
+/*PROCESSES USING THE SAME LIST. EMPTY LINES ARE SKIPPED, AND SO ARE        */
+/*CARRIAGE RETURNS BEFORE NEWLINES: A UNIT ENDS WHERE THE NEXT ONE STARTS,  */
+/*WITHOUT THE NEWLINES AND CARRIAGE RETURNS BEFORE IT                       */
+void
+load_word_list(generator_context *ctx, char *word_list)
+{
+	char *separator, *path, *name, *text, *point, *end;
+	int fd;
+	struct stat st;
+	size_t lines = 0;
+	symbol_list_entry *sle = NULL;
+	lexicon_structure *lex = NULL;
+
+	assert(ctx != NULL);
+	assert(word_list != NULL);
+
+	separator = strchr(word_list, ':');
+	if(separator == NULL || separator == word_list || separator[1] == '\0')
+		error(BAD_ARGUMENTS, 0, "%s: word list must be given as TOKEN:FILE", word_list);
+	path = separator + 1;
+
+	name = xmalloc(separator - word_list + 1);
+	memcpy(name, word_list, separator - word_list);
+	name[separator - word_list] = '\0';
+	sle = get_symbol_by_name_and_kind(ctx->symbol_table, name, 0);
+	if(sle == NULL || is_LEXICAL(sle) == 0)
+		error(BAD_ARGUMENTS, 0, "%s: no token called \"%s\" in the grammar", path, name);
+	if(get_lexicon_numerosity(sle) != 0)
+		error(BAD_ARGUMENTS, 0, "%s: token \"%s\" has a lexicon already", path, name);
+	free(name);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "mapping word list %s for token %s...\n", path, sle->name);
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0 || fstat(fd, &st) != 0)
+		error(BAD_ARGUMENTS, errno, "%s", path);
+	if(st.st_size == 0)
+	{
+		close(fd);
+		if(must_print_message(WARNING))
+			fprintf(message_stream, "warning: %s: empty word list\n", path);
+		return;
+	}
+
+	text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(text == MAP_FAILED)
+		error(UNEXPECTED_ERROR, errno, "%s", path);
+	close(fd);
+	end = text + st.st_size;
+
+	/*SIZE THE INDEX: ONE UNIT PER LINE AT MOST*/
+	madvise(text, st.st_size, MADV_SEQUENTIAL);
+	for(point = text; point < end; point++)
+	{
+		point = memchr(point, '\n', end - point);
+		if(point == NULL)
+			break;
+		lines++;
+	}
+	lines++;
+	if(lines > INT_MAX)
+		error(BAD_INPUT, 0, "%s: too many lines in word list", path);
+
+	lex = initialize_new_lexicon_structure();
+	lex->text = text;
+	lex->text_size = st.st_size;
+	lex->text_used = st.st_size;
+	lex->mapped = 1;
+	lex->lines = 1;
+	lex->unit_size = (int) lines;
+	lex->unit_start = xmalloc((lines + 1) * sizeof(size_t));
+	sle->rules = (rule_list_entry *) lex;
+
+	for(point = text; point < end; )
+	{
+		char *eol = memchr(point, '\n', end - point);
+		size_t length;
+
+		if(eol == NULL)
+			eol = end;
+		length = eol - point;
+		while(length > 0 && point[length - 1] == '\r')
+			length--;
+
+		if(length > 0)
+		{
+			lex->unit_start[lex->unit_count] = point - text;
+			lex->unit_count++;
+			increment_lexicon_numerosity(sle);
+		}
+		point = eol + 1;
+	}
+	lex->unit_start[lex->unit_count] = st.st_size;
+
+	/*UNITS ARE DRAWN AT RANDOM DURING GENERATION*/
+	madvise(text, st.st_size, MADV_RANDOM);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "...done: %d lexical units\n", lex->unit_count);
+}
+
+
+/*ADD A LEXICAL UNIT TO THE LEXICON STRUCTURE FOR TERMINAL SYMBOLS */
 /*TEXT IS READ FROM STRING 'yy_lexicontext', SET BY FLEX SCANNER*/
 void
-add_lexical_unit(symbol_id s_id)
+add_lexical_unit(generator_context *ctx, symbol_id s_id)
 {
 	symbol_list_entry *sle = NULL;
-	error_t err = 0;
 	int num = 0;
 
 	assert((int)s_id > 0);
 
-	sle = get_symbol(symbol_table, s_id);
+	sle = get_symbol(ctx->symbol_table, s_id);
 	assert(sle != NULL);
 
 	num = get_lexicon_numerosity(sle);
@@ -562,30 +1287,12 @@ add_lexical_unit(symbol_id s_id)
 
 	if(num == 0)
 	{
-		lexicon_argz_structure *lazs = NULL;
-
-		lazs = initialize_new_lexicon_argz_structure();
-		assert(lazs != NULL);
-		sle->rules = (rule_list_entry *) lazs;
-
-		increment_lexicon_numerosity(sle);
-		err = argz_add(&(lazs->argz), &(lazs)->argz_size, yy_lexicontext);
-	}
-	else
-	{
-		lexicon_argz_structure *lazs = NULL;
-
-		lazs = (lexicon_argz_structure *) sle->rules;
-		assert(lazs != NULL);
-
-		increment_lexicon_numerosity(sle);
-		err = argz_add(&(lazs->argz), &(lazs)->argz_size, yy_lexicontext);
+		sle->rules = (rule_list_entry *) initialize_new_lexicon_structure();
+		assert(sle->rules != NULL);
 	}
 
-	if(err != 0)
-	{
-		error(UNEXPECTED_ERROR, 0, "unexpected error: out of memory");
-	}
+	increment_lexicon_numerosity(sle);
+	insert_lexicon_unit((lexicon_structure *) sle->rules, yy_lexicontext);
 }
 
 
@@ -0,0 +1,108 @@
+/*
+context.c -- creation, selection and clean-up of generator contexts
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+
+/*MESSAGE STREAM AND VERBOSITY OF THE CONTEXT IN USE IN THE CURRENT THREAD*/
+/*THEY ARE READ BY must_print_message() AND BY ALL MESSAGE PRINTING CODE  */
+__thread FILE *message_stream = NULL;
+__thread int verbosity = DEFAULT_VERBOSITY;
+
+/*THE SCANNERS AND THE PARSER ARE NOT REENTRANT: THEY WORK ON THIS CONTEXT,*/
+/*SET BY build_tables() WHILE THE GRAMMAR IS BEING LOADED                  */
+generator_context *parsing_context = NULL;
+
+
+/*ALLOCATES A CONTEXT WITH THE DEFAULT OPTIONS AND NO GRAMMAR*/
+/*MESSAGES GO TO stdout, NO OUTPUT STREAM IS SET             */
+generator_context *
+initialize_new_generator_context()
+{
+	generator_context *ctx = NULL;
+
+	ctx = xcalloc(1, sizeof(generator_context));
+	ctx->message_stream = stdout;
+	ctx->verbosity = DEFAULT_VERBOSITY;
+	ctx->standard_output_flag = DEFAULT_STANDARD_OUTPUT_FLAG;
+	ctx->parse_tree_mode = DEFAULT_TREE_MODE;
+	ctx->criterion = DEFAULT_COVERAGE_CRITERION;
+	ctx->sentence_max_length = -1;
+	ctx->boltzmann_max_size = -1;
+
+	return ctx;
+}
+
+
+/*MAKES THE CURRENT THREAD PRINT MESSAGES AS REQUIRED BY ctx*/
+void
+use_generator_context(generator_context *ctx)
+{
+	assert(ctx != NULL);
+	assert(ctx->message_stream != NULL);
+
+	message_stream = ctx->message_stream;
+	verbosity = ctx->verbosity;
+}
+
+
+/*BUILDS, CHECKS AND COMPILES THE GRAMMAR OF ctx FROM IT'S INPUT STREAMS*/
+/*A COMPILED GRAMMAR FILE IS LOADED AS IT IS, WITHOUT ANY PARSING       */
+/*DOES NOT RETURN IN CASE OF ERRORS                                     */
+void
+load_grammar(generator_context *ctx)
+{
+	assert(ctx != NULL);
+	assert(ctx->symbol_table == NULL);
+
+	if(is_grammar_image_file(ctx->input_grammar_stream))
+	{
+		if(ctx->input_lexicon_flag != 0 || ctx->word_list_count > 0)
+			error(BAD_ARGUMENTS, 0, "%s: lexicons can not be added to a compiled grammar", ctx->input_grammar_file_path);
+		load_grammar_image(ctx);
+		return;
+	}
+
+	build_tables(ctx);
+	check_grammar(ctx);
+	compile_grammar(ctx->symbol_table);
+}
+
+
+/*FREES THE CONTEXT ctx AND IT'S GRAMMAR. STREAMS ARE LEFT OPEN*/
+void
+clean_generator_context(generator_context *ctx)
+{
+	assert(ctx != NULL);
+
+	if(ctx->symbol_table != NULL)
+	{
+		clean_symbol_list(ctx->symbol_table);
+	}
+	if(ctx->lengths != NULL)
+	{
+		clean_length_table(ctx->lengths);
+	}
+	if(ctx->coverage != NULL)
+	{
+		clean_coverage_table(ctx->coverage);
+	}
+	free(ctx->word_list);
+	free(ctx);
+}
@@ -0,0 +1,1111 @@
+/*
+coverage.c -- precomputation and sentence planning of the Purdom algorithm
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <pthread.h>
+
+/*THE PURDOM ALGORITHM COVERS ALL RULES OF THE GRAMMAR WITH SHORT        */
+/*SENTENCES. IT NEEDS, FOR EVERY SYMBOL, THE SHORTEST SENTENCE DERIVING  */
+/*FROM IT (THE shortest RULES OF compute_minimal_lengths()) AND THE      */
+/*SHORTEST SENTENCE OF THE STARTING SYMBOL WHOSE DERIVATION USES IT,     */
+/*TOGETHER WITH THE RULE INTRODUCING IT THERE. BOTH ARE COMPUTED ONCE, SO*/
+/*THAT EVERY SENTENCE IS PLANNED IN LINEAR TIME BY prepare_coverage_     */
+/*sentence() AND GENERATED BY purdom() WITHOUT ANY SEARCH                */
+
+
+/*WITH PAIR COVERAGE, THE SENTENCES ARE STEERED TOWARDS THE PARENT RULES*/
+/*OF THE PAIRS NOT COVERED YET, AND AT EVERY NON-TERMINAL A RULE MAKING A*/
+/*NEW PAIR WITH THE PARENT RULE IS PREFERRED (SEE choose() IN grow.c)    */
+
+
+/*RETURNS THE FIRST RULE OF THE WORKER TABLE ct FROM RULE first ON: THE*/
+/*RULES r OF A WORKER ARE THOSE WITH r % jobs == worker                 */
+static int
+first_own_rule(coverage_table *ct, int first)
+{
+	return first + (ct->worker - first % ct->jobs + ct->jobs) % ct->jobs;
+}
+
+
+/*RETURNS THE FIRST RULE OF SYMBOL s WHICH IS STILL TO BE COVERED (WITH  */
+/*PAIR COVERAGE, WHICH IS THE PARENT OF PAIRS STILL TO BE COVERED), OR -1*/
+/*IF own IS NOT ZERO, THE TABLE OF A WORKER ONLY LOOKS AT IT'S OWN RULES.*/
+/*THE CURSORS OF s ONLY MOVE FORWARD, SINCE NOTHING IS EVER UNCOVERED    */
+static int
+next_uncovered_rule(coverage_table *ct, grammar_image *image, symbol_id s, int own)
+{
+	int end = image->rule_offset[s] + image->rule_num[s];
+	int *cursor = &(ct->next_rule[s]), step = 1;
+
+	if(own != 0 && ct->jobs > 0)
+	{
+		cursor = &(ct->own_rule[s]);
+		step = ct->jobs;
+	}
+	while(*cursor < end)
+	{
+		int r = *cursor;
+
+		if(image->rule_min_length[r] != INT_MAX
+			&& ((ct->pair_pending != NULL)? ct->pair_pending[r] > 0 : BITSET_TEST(ct->covered_rules, r) == 0))
+			return r;
+		*cursor += step;
+	}
+	return -1;
+}
+
+
+/*RETURNS THE SYMBOL IN POSITION k*/
+static symbol_id
+position_symbol(coverage_table *ct, grammar_image *image, int k)
+{
+	return (k == image->rhs_size)? ct->starting_symbol : image->rhs[k];
+}
+
+
+/*RETURNS THE ELEMENT TO BE COVERED BY RULE r IN POSITION position: THE*/
+/*RULE ITSELF, OR WITH PAIR COVERAGE IT'S PAIR WITH THE POSITION'S RULE*/
+static int
+coverage_element(coverage_table *ct, grammar_image *image, int r, int position)
+{
+	int g;
+
+	if(ct->pair_group == NULL)
+		return r;
+	g = ct->pair_group[position];
+	assert(g >= 0);
+	return ct->pair_base[g] + r - image->rule_offset[image->rule_lhs[r]];
+}
+
+
+/*RETURNS THE RULE OF element, COVERED IN POSITION position*/
+static int
+element_rule(coverage_table *ct, grammar_image *image, int element, int position)
+{
+	int g;
+
+	if(ct->pair_group == NULL)
+		return element;
+	g = ct->pair_group[position];
+	assert(g >= 0);
+	return image->rule_offset[position_symbol(ct, image, g)] + element - ct->pair_base[g];
+}
+
+
+/*NUMBERS ALL THE PAIRS OF A RULE AND OF A RULE OF A NON-TERMINAL IN IT,  */
+/*AND COUNTS THOSE WHICH CAN BE COVERED: THE PARENT RULE MUST BE REACHABLE*/
+/*AND BOTH RULES PRODUCTIVE. THE STARTING SYMBOL IS GIVEN A PARENT OF IT'S*/
+/*OWN. THE PAIRS OF A SYMBOL REPEATED IN A RULE ARE THE SAME              */
+static void
+build_pair_table(coverage_table *ct, grammar_image *image)
+{
+	int r, k;
+
+	ct->pair_group = xmalloc((image->rhs_size + 1) * sizeof(int));
+	ct->pair_base = xmalloc((image->rhs_size + 1) * sizeof(int));
+	ct->pair_next = xmalloc((image->rhs_size + 1) * sizeof(int));
+	ct->pair_parent = xmalloc((image->rhs_size + 1) * sizeof(int));
+	ct->pair_pending = xcalloc(image->rule_count + 1, sizeof(int));
+
+	for(r = 0; r <= image->rule_count; r++)
+	{
+		int first, length, j;
+		int valid;
+
+		/*THE LAST "RULE" IS THE PARENT OF THE STARTING SYMBOL*/
+		if(r == image->rule_count)
+		{
+			first = image->rhs_size;
+			length = 1;
+			valid = 1;
+		}
+		else
+		{
+			first = (int)(image->rules[r].rhs - image->rhs);
+			length = image->rules[r].length;
+			valid = (ct->derivation_length[image->rule_lhs[r]] != INT_MAX
+				&& image->rule_min_length[r] != INT_MAX);
+		}
+
+		for(j = 0; j < length; j++)
+		{
+			symbol_id s;
+			int c;
+
+			k = first + j;
+			s = position_symbol(ct, image, k);
+			ct->pair_parent[k] = r;
+			ct->pair_group[k] = -1;
+			if(image->rule_num[s] == 0)
+				continue;
+
+			/*A SYMBOL ALREADY FOUND IN THE RULE HAS IT'S PAIRS ALREADY*/
+			for(c = first; c < k; c++)
+			{
+				if(image->rhs[c] == s)
+				{
+					ct->pair_group[k] = c;
+					break;
+				}
+			}
+			if(ct->pair_group[k] >= 0)
+				continue;
+
+			if(ct->pair_count > INT_MAX - image->rule_num[s])
+				error(BAD_INPUT, 0, "%s", "the grammar has too many rule pairs to cover");
+			ct->pair_group[k] = k;
+			ct->pair_base[k] = ct->pair_count;
+			ct->pair_next[k] = image->rule_offset[s];
+			ct->pair_count += image->rule_num[s];
+
+			for(c = image->rule_offset[s]; c < image->rule_offset[s] + image->rule_num[s] && valid; c++)
+			{
+				if(image->rule_min_length[c] == INT_MAX)
+					continue;
+				ct->pair_pending[r]++;
+				ct->uncovered_pairs++;
+			}
+		}
+	}
+
+	ct->covered_pairs = xcalloc(BITSET_WORDS(ct->pair_count) + 1, sizeof(unsigned long));
+}
+
+
+/*COMPUTES THE COVERAGE TABLE OF THE GRAMMAR OF ctx. A RULE r OF SYMBOL A */
+/*IS IN A SENTENCE OF derivation_length[A] - min_length[A] + rule_min_    */
+/*length[r] TOKENS AT BEST: RULES ARE QUEUED BY THAT LENGTH, AND THE FIRST*/
+/*ONE POPPED FINALIZES THE NON-TERMINALS IT CONTAINS (DIJKSTRA'S          */
+/*ALGORITHM). EVERY RULE IS QUEUED ONCE, SO THE PASS IS O(G log G) IN THE */
+/*SIZE OF THE GRAMMAR. RULES ALREADY VISITED COUNT AS COVERED. WITH PAIR */
+/*COVERAGE, THE TABLE OF THE PAIRS IS BUILT AS WELL                      */
+void
+build_coverage_table(generator_context *ctx)
+{
+	int i, queue_size = 0, symbols;
+	symbol_id start;
+	min_length_queue_entry *queue = NULL;
+	coverage_table *ct = NULL;
+	grammar_image *image = NULL;
+	symbol_list_entry *work_sle = NULL;
+
+	assert(ctx != NULL);
+	assert(ctx->coverage == NULL);
+	work_sle = ctx->symbol_table;
+	assert(work_sle != NULL);
+	image = work_sle->index->image;
+	assert(image != NULL);
+	start = ctx->starting_symbol;
+	assert(start != (symbol_id) 0);
+
+	symbols = work_sle->rulecount;
+	ct = xcalloc(1, sizeof(coverage_table));
+	ct->starting_symbol = start;
+	ct->covered_rules = xcalloc(BITSET_WORDS(image->rule_count) + 1, sizeof(unsigned long));
+	ct->derivation_length = xmalloc((symbols + 1) * sizeof(int));
+	ct->previous = xmalloc((symbols + 1) * sizeof(int));
+	ct->next_rule = xmalloc((symbols + 1) * sizeof(int));
+	ct->once = xmalloc((symbols + 1) * sizeof(int));
+	ct->pending = xmalloc((symbols + 1) * sizeof(symbol_id));
+	ct->planned = xmalloc((symbols + 1) * sizeof(symbol_id));
+	queue = xcalloc(image->rule_count + 1, sizeof(min_length_queue_entry));
+
+	for(i = 0; i <= symbols; i++)
+	{
+		ct->derivation_length[i] = INT_MAX;
+		ct->previous[i] = -1;
+		ct->next_rule[i] = image->rule_offset[i];
+		ct->once[i] = -1;
+	}
+
+	/*THE STARTING SYMBOL IS IN ALL SENTENCES*/
+	ct->derivation_length[start] = image->min_length[start];
+	for(i = image->rule_offset[start]; i < image->rule_offset[start] + image->rule_num[start]; i++)
+	{
+		if(image->rule_min_length[i] != INT_MAX)
+			min_length_queue_push(queue, &queue_size, image->rule_min_length[i], i);
+	}
+
+	while(queue_size > 0)
+	{
+		min_length_queue_entry e = min_length_queue_pop(queue, &queue_size);
+		rule_list_entry *rle = &(image->rules[e.rule]);
+		int j;
+
+		for(j = 0; j < rle->length; j++)
+		{
+			symbol_id s = rle->rhs[j];
+			int k;
+
+			if(image->rule_num[s] == 0 || ct->derivation_length[s] != INT_MAX)
+				continue;
+
+			ct->derivation_length[s] = e.length;
+			ct->previous[s] = e.rule;
+			for(k = image->rule_offset[s]; k < image->rule_offset[s] + image->rule_num[s]; k++)
+			{
+				if(image->rule_min_length[k] == INT_MAX)
+					continue;
+				min_length_queue_push(queue, &queue_size,
+					min_length_add(e.length - image->min_length[s], image->rule_min_length[k]), k);
+			}
+		}
+	}
+
+	/*ONLY THE REACHABLE AND PRODUCTIVE RULES CAN BE COVERED*/
+	for(i = 0; i < image->rule_count; i++)
+	{
+		if(image->rules[i].visited != 0)
+			BITSET_SET(ct->covered_rules, i);
+		if(ct->derivation_length[image->rule_lhs[i]] != INT_MAX
+			&& image->rule_min_length[i] != INT_MAX
+			&& image->rules[i].visited == 0)
+			ct->uncovered++;
+	}
+	for(i = 1; i <= symbols; i++)
+	{
+		if(ct->derivation_length[i] != INT_MAX && image->rule_num[i] != 0)
+			ct->pending[ct->pending_count++] = i;
+	}
+	if(ctx->criterion == PAIR_COVERAGE)
+		build_pair_table(ct, image);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "coverage table computed, %d rules and %d rule pairs to cover\n", ct->uncovered, ct->uncovered_pairs);
+
+	free(queue);
+	ctx->coverage = ct;
+}
+
+
+/*FREES THE COVERAGE TABLE ct*/
+void
+clean_coverage_table(coverage_table *ct)
+{
+	assert(ct != NULL);
+
+	free(ct->derivation_length);
+	free(ct->previous);
+	free(ct->next_rule);
+	free(ct->once);
+	free(ct->pending);
+	free(ct->planned);
+	free(ct->covered_rules);
+	free(ct->in_sentence);
+	free(ct->sentence_rules);
+	free(ct->sentence_positions);
+	free(ct->sentence_offset);
+	free(ct->pair_group);
+	free(ct->pair_base);
+	free(ct->pair_next);
+	free(ct->pair_parent);
+	free(ct->pair_pending);
+	free(ct->covered_pairs);
+	free(ct->kept_pair_keys);
+	free(ct);
+}
+
+
+/*CHOOSES THE RULES OF THE NEXT SENTENCE: A NON-TERMINAL WITH RULES TO BE*/
+/*COVERED USES THE FIRST OF THEM, AND EVERY NON-TERMINAL ON THE SHORTEST */
+/*DERIVATION FROM THE STARTING SYMBOL TO IT USES THE RULE LEADING THERE. */
+/*ALL OTHER NON-TERMINALS USE THEIR SHORTEST RULE. ONLY THE SYMBOLS OF   */
+/*THE pending AND planned LISTS ARE VISITED, AND EVERY SYMBOL IS PLANNED */
+/*AT MOST ONCE, SO THIS IS LINEAR IN THE SIZE OF THE PLAN. THE TABLE OF */
+/*A WORKER ONLY PLANS IT'S OWN RULES, AND LEAVES THE pending LIST AS IT  */
+/*IS (IT BELONGS TO THE MAIN TABLE)                                      */
+void
+prepare_coverage_sentence(coverage_table *ct, symbol_list_entry *symbol_table)
+{
+	int i, kept = 0, first_route;
+	grammar_image *image = NULL;
+
+	assert(ct != NULL);
+	assert(symbol_table != NULL);
+	image = symbol_table->index->image;
+	assert(image != NULL);
+
+	/*FORGET THE PLAN OF THE PREVIOUS SENTENCE*/
+	for(i = 0; i < ct->planned_count; i++)
+	{
+		ct->once[ct->planned[i]] = -1;
+	}
+	ct->planned_count = 0;
+
+	/*SYMBOLS WITHOUT RULES TO BE COVERED LEAVE THE pending LIST FOR GOOD*/
+	for(i = 0; i < ct->pending_count; i++)
+	{
+		symbol_id s = ct->pending[i];
+		int r;
+
+		r = next_uncovered_rule(ct, image, s, 1);
+		if(r < 0)
+			continue;
+		if(ct->jobs == 0)
+			ct->pending[kept++] = s;
+		ct->once[s] = r;
+		ct->planned[ct->planned_count++] = s;
+	}
+	if(ct->jobs == 0)
+		ct->pending_count = kept;
+
+	first_route = ct->planned_count;
+	for(i = 0; i < first_route; i++)
+	{
+		symbol_id s = ct->planned[i];
+
+		/*WALK UP TO THE STARTING SYMBOL, OR TO A SYMBOL ALREADY PLANNED*/
+		while(ct->previous[s] >= 0)
+		{
+			int r = ct->previous[s];
+			symbol_id lhs = image->rule_lhs[r];
+
+			if(ct->once[lhs] >= 0)
+				break;
+			ct->once[lhs] = r;
+			ct->planned[ct->planned_count++] = lhs;
+			s = lhs;
+		}
+	}
+}
+
+
+/*RETURNS A RULE OF THE SYMBOL IN POSITION position MAKING A PAIR NOT*/
+/*COVERED YET WITH THE RULE OF THE POSITION, OR NULL IF THERE IS NONE */
+/*(OR IF PAIRS ARE NOT COVERED). THE TABLE OF A WORKER PREFERS THE   */
+/*RULES OF IT'S OWN                                                   */
+rule_list_entry *
+get_uncovered_pair_rle(coverage_table *ct, symbol_list_entry *symbol_table, int position)
+{
+	grammar_image *image = NULL;
+	symbol_id s;
+	int g, end;
+
+	assert(ct != NULL);
+	assert(symbol_table != NULL);
+	image = symbol_table->index->image;
+	assert(image != NULL);
+
+	if(ct->pair_group == NULL)
+		return NULL;
+
+	assert(position >= 0 && position <= image->rhs_size);
+	g = ct->pair_group[position];
+	assert(g >= 0);
+	s = position_symbol(ct, image, position);
+	end = image->rule_offset[s] + image->rule_num[s];
+
+	while(ct->jobs > 0 && ct->pair_own_next[g] < end)
+	{
+		int c = ct->pair_own_next[g];
+
+		if(image->rule_min_length[c] != INT_MAX
+			&& BITSET_TEST(ct->covered_pairs, ct->pair_base[g] + c - image->rule_offset[s]) == 0)
+			return &(image->rules[c]);
+		ct->pair_own_next[g] += ct->jobs;
+	}
+	while(ct->pair_next[g] < end)
+	{
+		int c = ct->pair_next[g];
+
+		if(image->rule_min_length[c] != INT_MAX
+			&& BITSET_TEST(ct->covered_pairs, ct->pair_base[g] + c - image->rule_offset[s]) == 0)
+			return &(image->rules[c]);
+		ct->pair_next[g]++;
+	}
+	return NULL;
+}
+
+
+/*MARKS RULE r AS COVERED, AND WITH PAIR COVERAGE IT'S PAIR WITH THE   */
+/*RULE OF POSITION position, UNLESS position IS NEGATIVE. r MUST BE      */
+/*REACHABLE AND PRODUCTIVE. RETURNS 1 IF ANY OF THEM WAS NOT COVERED YET */
+int
+mark_covered(coverage_table *ct, grammar_image *image, int r, int position)
+{
+	int added = 0;
+
+	if(ct->pair_group != NULL && position >= 0)
+	{
+		int element = coverage_element(ct, image, r, position);
+
+		if(BITSET_TEST(ct->covered_pairs, element) == 0)
+		{
+			BITSET_SET(ct->covered_pairs, element);
+			assert(ct->pair_pending[ct->pair_parent[position]] > 0);
+			ct->pair_pending[ct->pair_parent[position]]--;
+			ct->uncovered_pairs--;
+			added = 1;
+		}
+	}
+
+	if(BITSET_TEST(ct->covered_rules, r) == 0)
+	{
+		BITSET_SET(ct->covered_rules, r);
+		assert(ct->uncovered > 0);
+		ct->uncovered--;
+		added = 1;
+	}
+	return added;
+}
+
+
+/*APPENDS element, USED IN POSITION position, TO THE RULES (OR PAIRS) OF*/
+/*THE CURRENT SENTENCE RECORDED IN ct                                   */
+static void
+record_element(coverage_table *ct, int element, int position)
+{
+	if(ct->sentence_rules_used == ct->sentence_rules_size)
+	{
+		ct->sentence_rules_size *= 2;
+		ct->sentence_rules = realloc(ct->sentence_rules, ct->sentence_rules_size * sizeof(int));
+		ct->sentence_positions = realloc(ct->sentence_positions, ct->sentence_rules_size * sizeof(int));
+		if(ct->sentence_rules == NULL || ct->sentence_positions == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+	}
+	ct->sentence_positions[ct->sentence_rules_used] = position;
+	ct->sentence_rules[ct->sentence_rules_used++] = element;
+}
+
+
+/*RECORDS THAT RULE rle HAS BEEN USED IN POSITION position (ALSO AMONG   */
+/*THE RULES, OR PAIRS, OF THE SENTENCE IF THEY ARE RECORDED), AND SETS   */
+/*THE RULE TO BE USED BY IT'S LEFT-HAND SIDE FROM NOW ON IN THE SENTENCE:*/
+/*THE NEXT ONE TO BE COVERED, IF ANY, OR THE SHORTEST ONE. WITH PAIR     */
+/*COVERAGE, THE PLAN OF THE LEFT-HAND SIDE IS ONLY DROPPED ONCE USED. AS */
+/*EVERY PLANNED RULE IS USED AT MOST ONCE, AND EVERY OTHER RULE OUTSIDE  */
+/*THE SHORTEST ONES MAKES A NEW PAIR, THE SENTENCE IS FINITE. THE TABLE  */
+/*OF A WORKER KEEPS COVERING IT'S OWN RULES FIRST, AND LEAVES THE       */
+/*visited FIELDS ALONE                                                   */
+void
+cover_rule(coverage_table *ct, symbol_list_entry *symbol_table, rule_list_entry *rle, int position)
+{
+	grammar_image *image = NULL;
+	symbol_id lhs;
+	int r, element;
+
+	assert(ct != NULL);
+	assert(symbol_table != NULL);
+	image = symbol_table->index->image;
+	assert(image != NULL);
+
+	r = get_rule_index(symbol_table, rle);
+	lhs = image->rule_lhs[r];
+	element = coverage_element(ct, image, r, position);
+	mark_covered(ct, image, r, position);
+
+	if(ct->in_sentence != NULL && BITSET_TEST(ct->in_sentence, element) == 0)
+	{
+		BITSET_SET(ct->in_sentence, element);
+		record_element(ct, element, position);
+	}
+	/*THE COUNTER MUST NOT WRAP AROUND TO ZERO*/
+	if(ct->jobs == 0 && rle->visited < SHRT_MAX)
+		rle->visited++;
+
+	if(ct->pair_group != NULL)
+	{
+		if(ct->once[lhs] == r)
+			ct->once[lhs] = -1;
+	}
+	else
+	{
+		ct->once[lhs] = next_uncovered_rule(ct, image, lhs, 1);
+		if(ct->once[lhs] < 0)
+			ct->once[lhs] = next_uncovered_rule(ct, image, lhs, 0);
+	}
+}
+
+
+/*STARTS RECORDING THE RULES (OR PAIRS) USED BY EVERY SENTENCE IN ct, */
+/*THERE BEING elements OF THEM                                       */
+static void
+record_coverage_sentences(coverage_table *ct, int elements)
+{
+	assert(ct != NULL);
+	assert(ct->in_sentence == NULL);
+
+	ct->in_sentence = xcalloc(BITSET_WORDS(elements) + 1, sizeof(unsigned long));
+	ct->sentence_rules_size = COVERAGE_RECORD_DEFAULT_SIZE;
+	ct->sentence_rules = xmalloc(ct->sentence_rules_size * sizeof(int));
+	ct->sentence_positions = xmalloc(ct->sentence_rules_size * sizeof(int));
+	ct->sentence_offset_size = COVERAGE_RECORD_DEFAULT_SIZE;
+	ct->sentence_offset = xmalloc(ct->sentence_offset_size * sizeof(int));
+	ct->sentence_offset[0] = 0;
+}
+
+
+/*CLOSES THE RULES OF THE CURRENT SENTENCE, AND CLEARS in_sentence FOR THE*/
+/*NEXT ONE                                                                */
+static void
+end_coverage_sentence(coverage_table *ct)
+{
+	int k;
+
+	assert(ct != NULL);
+	assert(ct->in_sentence != NULL);
+
+	for(k = ct->sentence_offset[ct->sentences]; k < ct->sentence_rules_used; k++)
+	{
+		BITSET_CLEAR(ct->in_sentence, ct->sentence_rules[k]);
+	}
+
+	if(ct->sentences + 2 > ct->sentence_offset_size)
+	{
+		ct->sentence_offset_size *= 2;
+		ct->sentence_offset = realloc(ct->sentence_offset, ct->sentence_offset_size * sizeof(int));
+		if(ct->sentence_offset == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+	}
+	ct->sentence_offset[++ct->sentences] = ct->sentence_rules_used;
+}
+
+
+/*SELECTS IN kept A SUBSET OF THE RECORDED SENTENCES USING ALL THE RULES  */
+/*(OR PAIRS) USED BY ALL OF THEM, AND RETURNS IT'S SIZE. THE GREEDY SET COVER TAKES, */
+/*AT EVERY STEP, THE SENTENCE WITH MOST RULES NOT USED YET. GAINS ONLY    */
+/*DECREASE, SO THEY ARE KEPT IN A PRIORITY QUEUE AND RECOMPUTED ONLY WHEN */
+/*THEY REACH THE TOP. AFTERWARDS, THE SENTENCES WHOSE RULES ARE ALL USED  */
+/*BY OTHER SENTENCES ARE DROPPED, FROM THE LAST ONE SELECTED              */
+static int
+minimize_coverage_set(coverage_table *ct, int elements, char *kept)
+{
+	int j, k, queue_size = 0, selected = 0, result;
+	int *order = NULL, *uses = NULL;
+	unsigned long *covered = NULL;
+	min_length_queue_entry *queue = NULL;
+
+	assert(ct != NULL);
+	assert(kept != NULL);
+
+	covered = xcalloc(BITSET_WORDS(elements) + 1, sizeof(unsigned long));
+	uses = xcalloc(elements + 1, sizeof(int));
+	order = xcalloc(ct->sentences + 1, sizeof(int));
+	queue = xcalloc(ct->sentences + 1, sizeof(min_length_queue_entry));
+
+	/*THE QUEUE POPS THE SMALLEST LENGTH FIRST, SO GAINS ARE NEGATED*/
+	for(j = 0; j < ct->sentences; j++)
+	{
+		kept[j] = 0;
+		min_length_queue_push(queue, &queue_size, ct->sentence_offset[j] - ct->sentence_offset[j + 1], j);
+	}
+
+	while(queue_size > 0)
+	{
+		min_length_queue_entry e = min_length_queue_pop(queue, &queue_size);
+		int gain = 0;
+
+		j = e.rule;
+		for(k = ct->sentence_offset[j]; k < ct->sentence_offset[j + 1]; k++)
+		{
+			if(BITSET_TEST(covered, ct->sentence_rules[k]) == 0)
+				gain++;
+		}
+
+		if(gain == 0)
+			continue;
+		/*A STALE GAIN GOES BACK IN THE QUEUE*/
+		if(gain != -e.length)
+		{
+			min_length_queue_push(queue, &queue_size, -gain, j);
+			continue;
+		}
+
+		kept[j] = 1;
+		order[selected++] = j;
+		for(k = ct->sentence_offset[j]; k < ct->sentence_offset[j + 1]; k++)
+		{
+			BITSET_SET(covered, ct->sentence_rules[k]);
+			uses[ct->sentence_rules[k]]++;
+		}
+	}
+
+	result = selected;
+	while(selected > 0)
+	{
+		int redundant = 1;
+
+		j = order[--selected];
+		for(k = ct->sentence_offset[j]; k < ct->sentence_offset[j + 1] && redundant == 1; k++)
+		{
+			if(uses[ct->sentence_rules[k]] < 2)
+				redundant = 0;
+		}
+		if(redundant == 0)
+			continue;
+
+		kept[j] = 0;
+		result--;
+		for(k = ct->sentence_offset[j]; k < ct->sentence_offset[j + 1]; k++)
+		{
+			uses[ct->sentence_rules[k]]--;
+		}
+	}
+
+	free(covered);
+	free(uses);
+	free(order);
+	free(queue);
+	return result;
+}
+
+
+/*WORK OF A SINGLE THREAD IN A ROUND OF generate_coverage_rounds(): THE */
+/*SENTENCES OF THE THREAD ARE WRITTEN IN MEMORY, THE j-TH ONE FROM      */
+/*text_offset[j] TO text_offset[j+1], AND THE RULES (OR PAIRS) THEY USE */
+/*ARE RECORDED IN THE WORKER TABLE OF ctx. THE FIRST sync_count RULES OF*/
+/*sync_rules (USED IN POSITIONS sync_positions) WERE COVERED BY THE     */
+/*OTHER THREADS IN THE PREVIOUS ROUND                                   */
+typedef struct COVERAGE_WORK
+{
+	generator_context ctx;
+	generation_state *gs;
+	unsigned long first_sentence;
+	char *text;
+	size_t text_size;
+	size_t *text_offset;
+	int *sync_rules;
+	int *sync_positions;
+	int sync_count;
+} coverage_work;
+
+
+/*RETURNS THE TABLE OF THE WORKER worker OUT OF jobs FOR ct, RECORDING  */
+/*THE SENTENCES. symbols IS THE NUMBER OF SYMBOLS, AND elements THE      */
+/*NUMBER OF RULES (OR PAIRS) TO BE COVERED                               */
+static coverage_table *
+clone_coverage_table(coverage_table *ct, grammar_image *image, int symbols, int elements, int jobs, int worker)
+{
+	coverage_table *c = NULL;
+	int i, words;
+
+	c = xmalloc(sizeof(coverage_table));
+	*c = *ct;
+	c->jobs = jobs;
+	c->worker = worker;
+	c->next_rule = xmalloc((symbols + 1) * sizeof(int));
+	memcpy(c->next_rule, ct->next_rule, (symbols + 1) * sizeof(int));
+	c->own_rule = xmalloc((symbols + 1) * sizeof(int));
+	for(i = 0; i <= symbols; i++)
+	{
+		c->own_rule[i] = first_own_rule(c, ct->next_rule[i]);
+	}
+	c->once = xmalloc((symbols + 1) * sizeof(int));
+	for(i = 0; i <= symbols; i++)
+	{
+		c->once[i] = -1;
+	}
+	c->planned = xmalloc((symbols + 1) * sizeof(symbol_id));
+	c->planned_count = 0;
+	words = BITSET_WORDS(image->rule_count) + 1;
+	c->covered_rules = xmalloc(words * sizeof(unsigned long));
+	memcpy(c->covered_rules, ct->covered_rules, words * sizeof(unsigned long));
+
+	if(ct->pair_group != NULL)
+	{
+		c->pair_next = xmalloc((image->rhs_size + 1) * sizeof(int));
+		memcpy(c->pair_next, ct->pair_next, (image->rhs_size + 1) * sizeof(int));
+		c->pair_own_next = xmalloc((image->rhs_size + 1) * sizeof(int));
+		for(i = 0; i <= image->rhs_size; i++)
+		{
+			if(ct->pair_group[i] == i)
+				c->pair_own_next[i] = first_own_rule(c, ct->pair_next[i]);
+		}
+		c->pair_pending = xmalloc((image->rule_count + 1) * sizeof(int));
+		memcpy(c->pair_pending, ct->pair_pending, (image->rule_count + 1) * sizeof(int));
+		words = BITSET_WORDS(ct->pair_count) + 1;
+		c->covered_pairs = xmalloc(words * sizeof(unsigned long));
+		memcpy(c->covered_pairs, ct->covered_pairs, words * sizeof(unsigned long));
+	}
+
+	c->in_sentence = NULL;
+	c->sentences = 0;
+	c->sentence_rules_used = 0;
+	record_coverage_sentences(c, elements);
+	return c;
+}
+
+
+/*FREES THE WORKER TABLE c, BUT NOT THE ARRAYS IT SHARES*/
+static void
+clean_coverage_clone(coverage_table *c)
+{
+	assert(c != NULL);
+	assert(c->jobs > 0);
+
+	free(c->next_rule);
+	free(c->own_rule);
+	free(c->once);
+	free(c->planned);
+	free(c->covered_rules);
+	free(c->in_sentence);
+	free(c->sentence_rules);
+	free(c->sentence_positions);
+	free(c->sentence_offset);
+	if(c->pair_group != NULL)
+	{
+		free(c->pair_next);
+		free(c->pair_own_next);
+		free(c->pair_pending);
+		free(c->covered_pairs);
+	}
+	free(c);
+}
+
+
+/*TELLS IF THE WORKER TABLE ct HAS RULES (OR PAIRS) OF IT'S OWN TO COVER*/
+static int
+has_own_coverage(coverage_table *ct, grammar_image *image)
+{
+	int i;
+
+	if(ct->worker == 0 && ct->pair_pending != NULL && ct->pair_pending[image->rule_count] > 0)
+		return 1;
+	for(i = 0; i < ct->pending_count; i++)
+	{
+		if(next_uncovered_rule(ct, image, ct->pending[i], 1) >= 0)
+			return 1;
+	}
+	return 0;
+}
+
+
+/*THREAD BODY: BRINGS THE WORKER TABLE UP TO DATE, THEN GENERATES UP TO*/
+/*COVERAGE_SENTENCES_PER_JOB SENTENCES, WHILE THERE IS SOMETHING OF IT'S*/
+/*OWN TO COVER. EVERY SENTENCE HAS IT'S OWN RANDOM SEQUENCE             */
+static void *
+generate_coverage_worker(void *arg)
+{
+	coverage_work *w = (coverage_work *) arg;
+	coverage_table *ct = w->ctx.coverage;
+	grammar_image *image = w->ctx.symbol_table->index->image;
+	int k;
+
+	use_generator_context(&(w->ctx));
+	for(k = 0; k < w->sync_count; k++)
+	{
+		mark_covered(ct, image, w->sync_rules[k], w->sync_positions[k]);
+	}
+
+	ct->sentences = 0;
+	ct->sentence_rules_used = 0;
+	w->text_offset[0] = 0;
+	while(ct->sentences < COVERAGE_SENTENCES_PER_JOB && has_own_coverage(ct, image))
+	{
+		seed_generation_state(w->gs, w->ctx.seed, w->first_sentence + ct->sentences);
+		purdom(&(w->ctx), w->gs);
+		end_coverage_sentence(ct);
+		flush_output(w->gs);
+		fflush(w->gs->output);
+		w->text_offset[ct->sentences] = w->text_size;
+	}
+
+	return NULL;
+}
+
+
+/*GENERATES THE COVERAGE SENTENCES OF generate_coverage() WITH jobs      */
+/*THREADS. THE RULES OF EVERY SYMBOL ARE SHARED OUT AMONG THE THREADS,  */
+/*SO THAT AT EVERY ROUND EACH ONE PLANS ALL THE SYMBOLS OF THE pending   */
+/*LIST TOWARDS THE RULES (OR PAIRS) LEFT TO ITSELF, WITH SENTENCES AS    */
+/*DENSE AS WITH A SINGLE JOB. THEN THE SENTENCES ARE TAKEN IN THE ORDER  */
+/*OF THEIR THREADS: THOSE COVERING SOMETHING NEW ARE WRITTEN WITH gs, AND*/
+/*(IF text_offset IS NOT NULL) RECORDED IN THE MAIN TABLE, WHILE THE    */
+/*OTHERS ARE DROPPED. THE RULES COVERED ARE PASSED TO ALL THREADS FOR THE*/
+/*NEXT ROUND. THE OUTPUT DEPENDS ON jobs, BUT NOT ON THE SCHEDULING      */
+static void
+generate_coverage_rounds(generator_context *ctx, generation_state *gs, char *separator, int jobs,
+	int elements, size_t **text_offset, size_t *text_size)
+{
+	int t, symbols, first = 1, sync_size;
+	int *sync_rules = NULL, *sync_positions = NULL, sync_count = 0;
+	unsigned long generated = 0;
+	coverage_table *ct = ctx->coverage;
+	grammar_image *image = ctx->symbol_table->index->image;
+	coverage_work *work = NULL;
+	pthread_t *threads = NULL;
+
+	symbols = ctx->symbol_table->rulecount;
+	sync_size = COVERAGE_RECORD_DEFAULT_SIZE;
+	sync_rules = xmalloc(sync_size * sizeof(int));
+	sync_positions = xmalloc(sync_size * sizeof(int));
+	threads = xcalloc(jobs, sizeof(pthread_t));
+	work = xcalloc(jobs, sizeof(coverage_work));
+	for(t = 0; t < jobs; t++)
+	{
+		work[t].ctx = *ctx;
+		work[t].ctx.coverage = clone_coverage_table(ct, image, symbols, elements, jobs, t);
+		work[t].gs = initialize_new_generation_state(NULL, ctx->starting_symbol, 0);
+		work[t].text_offset = xmalloc((COVERAGE_SENTENCES_PER_JOB + 1) * sizeof(size_t));
+	}
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "generating coverage sentences with %d threads\n", jobs);
+
+	while(ct->uncovered > 0 || ct->uncovered_pairs > 0)
+	{
+		int added = 0;
+
+		/*THE pending LIST OF THE MAIN TABLE IS COMPACTED BY PLANNING IT*/
+		prepare_coverage_sentence(ct, ctx->symbol_table);
+
+		for(t = 0; t < jobs; t++)
+		{
+			coverage_work *w = &(work[t]);
+			int ret;
+
+			w->ctx.coverage->pending_count = ct->pending_count;
+			w->sync_rules = sync_rules;
+			w->sync_positions = sync_positions;
+			w->sync_count = sync_count;
+			w->first_sentence = generated + (unsigned long) t * COVERAGE_SENTENCES_PER_JOB;
+			w->gs->output = open_memstream(&(w->text), &(w->text_size));
+			if(w->gs->output == NULL)
+				error(UNEXPECTED_ERROR, errno, "%s", "could not open a memory stream");
+
+			ret = pthread_create(&(threads[t]), NULL, generate_coverage_worker, w);
+			if(ret != 0)
+				error(UNEXPECTED_ERROR, ret, "%s", "could not create a generation thread");
+		}
+		generated += (unsigned long) jobs * COVERAGE_SENTENCES_PER_JOB;
+
+		/*THE THREADS READ sync_rules UNTIL THEY ARE ALL DONE*/
+		for(t = 0; t < jobs; t++)
+		{
+			int ret;
+
+			ret = pthread_join(threads[t], NULL);
+			if(ret != 0)
+				error(UNEXPECTED_ERROR, ret, "%s", "could not join a generation thread");
+			fclose(work[t].gs->output);
+		}
+
+		sync_count = 0;
+		for(t = 0; t < jobs; t++)
+		{
+			coverage_work *w = &(work[t]);
+			coverage_table *wt = w->ctx.coverage;
+			int j, k;
+
+			for(j = 0; j < wt->sentences; j++)
+			{
+				int fresh = 0;
+
+				for(k = wt->sentence_offset[j]; k < wt->sentence_offset[j + 1]; k++)
+				{
+					int position = wt->sentence_positions[k];
+					int r = element_rule(wt, image, wt->sentence_rules[k], position);
+
+					if(mark_covered(ct, image, r, position) == 0)
+						continue;
+					fresh = 1;
+					if(sync_count == sync_size)
+					{
+						sync_size *= 2;
+						sync_rules = realloc(sync_rules, sync_size * sizeof(int));
+						sync_positions = realloc(sync_positions, sync_size * sizeof(int));
+						if(sync_rules == NULL || sync_positions == NULL)
+							error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+					}
+					sync_rules[sync_count] = r;
+					sync_positions[sync_count++] = position;
+				}
+				if(fresh == 0)
+					continue;
+				added++;
+
+				for(k = wt->sentence_offset[j]; k < wt->sentence_offset[j + 1]; k++)
+				{
+					int position = wt->sentence_positions[k];
+					int r = element_rule(wt, image, wt->sentence_rules[k], position);
+
+					/*THE COUNTER MUST NOT WRAP AROUND TO ZERO*/
+					if(image->rules[r].visited < SHRT_MAX)
+						image->rules[r].visited++;
+					if(text_offset != NULL)
+						record_element(ct, wt->sentence_rules[k], position);
+				}
+
+				if(text_offset == NULL && first == 0)
+					write_output(gs, separator, strlen(separator));
+				write_output(gs, w->text + w->text_offset[j], w->text_offset[j + 1] - w->text_offset[j]);
+				first = 0;
+
+				if(text_offset != NULL)
+				{
+					end_coverage_sentence(ct);
+					flush_output(gs);
+					fflush(gs->output);
+					*text_offset = realloc(*text_offset, (ct->sentences + 1) * sizeof(size_t));
+					if(*text_offset == NULL)
+						error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+					(*text_offset)[ct->sentences] = *text_size;
+				}
+			}
+			free(w->text);
+		}
+
+		/*THE FIRST THREAD WITH SOMETHING TO COVER ALWAYS COVERS IT*/
+		assert(added > 0);
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "%d sentences added, %d rules and %d rule pairs left to cover\n",
+				added, ct->uncovered, ct->uncovered_pairs);
+	}
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "complete coverage reached\n");
+
+	for(t = 0; t < jobs; t++)
+	{
+		clean_coverage_clone(work[t].ctx.coverage);
+		clean_generation_state(work[t].gs);
+		free(work[t].text_offset);
+	}
+	free(work);
+	free(threads);
+	free(sync_rules);
+	free(sync_positions);
+}
+
+
+/*GENERATES ON THE OUTPUT STREAM OF ctx A SET OF SENTENCES USING ALL THE  */
+/*RULES (OR PAIRS) OF THE GRAMMAR, WITH THE PURDOM ALGORITHM. WITH MORE  */
+/*THAN ONE JOB, THE WORK IS SHARED BY jobs THREADS (SEE generate_coverage_*/
+/*rounds()). IF minimize IS NOT ZERO, THE SENTENCES AND THE RULES (OR     */
+/*PAIRS) THEY USE ARE KEPT IN MEMORY, AND ONLY A SUBSET OF THEM USING THE */
+/*SAME ONES IS WRITTEN (SEE minimize_coverage_set()). WITH A COVERAGE    */
+/*STATE FILE, WHAT IT LISTS NEEDS NO SENTENCES, AND IT IS UPDATED AT THE  */
+/*END                                                                     */
+void
+generate_coverage(generator_context *ctx, char *separator, int minimize, int jobs)
+{
+	int j, elements, count = 1;
+	char *text = NULL, *kept = NULL;
+	size_t text_size = 0, *text_offset = NULL;
+	FILE *text_stream = NULL;
+	generation_state *gs = NULL;
+	coverage_table *ct = NULL;
+
+	assert(ctx != NULL);
+	assert(ctx->symbol_table != NULL);
+	assert(ctx->output_stream != NULL);
+	assert(jobs >= 1);
+
+	gs = initialize_new_generation_state(ctx->output_stream, ctx->starting_symbol, 0);
+	seed_generation_state(gs, ctx->seed, 0);
+	build_coverage_table(ctx);
+	ct = ctx->coverage;
+	if(ctx->coverage_state_file_path != NULL)
+		load_coverage_state(ctx, ctx->coverage_state_file_path);
+	elements = (ct->pair_group != NULL)? ct->pair_count : ctx->symbol_table->index->image->rule_count;
+
+	if(minimize != 0)
+	{
+		text_stream = open_memstream(&text, &text_size);
+		if(text_stream == NULL)
+			error(UNEXPECTED_ERROR, errno, "%s", "could not open a memory stream");
+		gs->output = text_stream;
+		record_coverage_sentences(ct, elements);
+		/*SENTENCE j IS IN text FROM text_offset[j] TO text_offset[j+1]*/
+		text_offset = xmalloc(sizeof(size_t));
+		text_offset[0] = 0;
+	}
+
+	if(ct->uncovered == 0 && ct->uncovered_pairs == 0)
+	{
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "complete coverage reached, no sentences needed\n");
+	}
+	else if(jobs > 1)
+		generate_coverage_rounds(ctx, gs, separator, jobs, elements, (minimize != 0)? &text_offset : NULL, &text_size);
+	else
+	{
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "sentence %d:\n", count);
+
+		while(1)
+		{
+			purdom(ctx, gs);
+
+			if(minimize != 0)
+			{
+				end_coverage_sentence(ct);
+				flush_output(gs);
+				fflush(text_stream);
+				text_offset = realloc(text_offset, (ct->sentences + 1) * sizeof(size_t));
+				if(text_offset == NULL)
+					error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+				text_offset[ct->sentences] = text_size;
+			}
+
+			if(ct->uncovered == 0 && ct->uncovered_pairs == 0)
+			{
+				if(must_print_message(MAIN))
+				{
+					fprintf(message_stream, "complete coverage reached\n");
+				}
+				break;
+			}
+
+			count++;
+			if(must_print_message(MAIN))
+			{
+				fprintf(message_stream, "more sentences needed, sentence %d:\n", count);
+			}
+
+			if(minimize == 0)
+				write_output(gs, separator, strlen(separator));
+		}
+	}
+	flush_output(gs);
+
+	if(minimize != 0)
+	{
+		int first = 1, result;
+
+		fclose(text_stream);
+		kept = xmalloc(ct->sentences);
+		result = minimize_coverage_set(ct, elements, kept);
+
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "coverage set reduced from %d to %d sentences\n", ct->sentences, result);
+
+		/*THE SENTENCES KEPT ARE WRITTEN IN THEIR ORDER OF GENERATION*/
+		gs->output = ctx->output_stream;
+		for(j = 0; j < ct->sentences; j++)
+		{
+			if(kept[j] == 0)
+				continue;
+			if(first == 0)
+				write_output(gs, separator, strlen(separator));
+			write_output(gs, text + text_offset[j], text_offset[j + 1] - text_offset[j]);
+			first = 0;
+		}
+		flush_output(gs);
+
+		free(kept);
+		free(text_offset);
+		free(text);
+	}
+
+	if(ctx->coverage_state_file_path != NULL)
+		save_coverage_state(ctx, ctx->coverage_state_file_path);
+	clean_generation_state(gs);
+}
@@ -21,8 +21,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <generation.h>
 
-extern FILE *output_stream, *message_stream;
-extern short int no_spaces_flag;
+/*THE STACK OF purdom() HOLDS A SYMBOL AND IT'S POSITION IN THE RIGHT-HAND*/
+/*SIDES OF THE GRAMMAR IMAGE (SEE coverage_table)                         */
+#define PACK_POSITION(s, k) ((((symbol_id)(k)) << 32) | (s))
+#define PACKED_SYMBOL(p) ((p) & 0xFFFFFFFFUL)
+#define PACKED_POSITION(p) ((int)((p) >> 32))
 
 
 /*NAVIGATES THE GRAMMAR TREE RECURSIVELY TO OBTAIN THE SHORTEST SENTENCE */
@@ -31,11 +34,12 @@ extern short int no_spaces_flag;
 
 /*THIS FUNCTION IS CURRENTLY NOT USED*/
 void
-grow_shortest(symbol_list_entry *sle, symbol_list_entry *symbol_table)
+grow_shortest(generator_context *ctx, generation_state *gs, symbol_list_entry *sle)
 {
 	int i=0;
 	symbol_list_entry *s = NULL;
 	rule_list_entry *r = NULL;
+	symbol_list_entry *symbol_table = ctx->symbol_table;
 
 	assert(sle != NULL);
 	assert(is_NT(sle) == 1);	
@@ -57,14 +61,14 @@ grow_shortest(symbol_list_entry *sle, symbol_list_entry *symbol_table)
 		assert(s != NULL);
 		if(is_NT(s) == 1)
 		{
-			grow_shortest(s, symbol_table);
+			grow_shortest(ctx, gs, s);
 		}
 		else
 		{
-			generate_terminal_text(s);
+			generate_terminal_text(gs, s, symbol_table);
 
-			if(no_spaces_flag == 0)
-				generate_blank_text();
+			if(ctx->no_spaces_flag == 0)
+				generate_blank_text(gs);
 		}
 	}
 
@@ -74,32 +78,40 @@ grow_shortest(symbol_list_entry *sle, symbol_list_entry *symbol_table)
 	}
 }
 
+/*RETURNS THE NODE OF THE NEXT SYMBOL TO BE POPPED: THE FIRST UNEXPANDED*/
+/*CHILD OF node OR, IF THERE IS NONE, OF THE CLOSEST ANCESTOR HAVING ONE */
 tree_node* get_current_tree(tree_node* node){
-	assert(node!=NULL);
-	tree_node ** children = node->children;
-	if(node->num_children==0){
-		return node->parent;
-	}
-	int i;
-	for(i=0; i < node->num_children; i++){
-		tree_node* child = children[i];
-		if(child->expanded==0){
-			child->expanded=1;
-			return child;
+	while(node != NULL){
+		int i;
+		for(i=0; i < node->num_children; i++){
+			tree_node* child = node->children[i];
+			if(child->expanded==0){
+				child->expanded=1;
+				return child;
+			}
 		}
+		node = node->parent;
 	}
-	return node->parent;
+	return NULL;
 }
 
 /*IMPLEMENTATION OF THE GROW ALGORITHM. */
-/*GENERATES A SINGLE SINTACTICALLY VALID SENTENCE OF THE TARGET GRAMMAR */
+/*GENERATES A SINGLE SINTACTICALLY VALID SENTENCE OF THE GRAMMAR OF ctx */
+/*THE SENTENCE IS WRITTEN ON THE OUTPUT OF gs, USING IT'S RANDOM NUMBER*/
+/*GENERATOR AND IT'S STACK. IF gs HAS A PARSE TREE, IT IS RESET AND     */
+/*FILLED WITH THE PARSE TREE OF THE SENTENCE, OTHERWISE NO TREE         */
+/*BOOKKEEPING IS DONE AT ALL. THE GRAMMAR IS NOT MODIFIED, SO DIFFERENT */
+/*THREADS CAN RUN grow() AT THE SAME TIME WITH DIFFERENT STATES         */
 void
-grow(symbol_id starting_symbol, symbol_list_entry *symbol_table)
+grow(generator_context *ctx, generation_state *gs)
 {
+	symbol_id starting_symbol = ctx->starting_symbol;
+	symbol_list_entry *symbol_table = ctx->symbol_table;
 	stack *st;
-	parse_tree* pt;
-	tree_node *current_tree;
+	parse_tree *work_tree;
+	tree_node *current_tree = NULL;
 	symbol_id current = (symbol_id) 0;
+	int added_rules = 0;
 	
 	/*OPTIONAL MESSAGE PRINTING FOR EXECUTION TRACING*/
 	if(must_print_message(GENERATION))
@@ -108,16 +120,21 @@ grow(symbol_id starting_symbol, symbol_list_entry *symbol_table)
 	}
 
 	assert(starting_symbol != (symbol_id) 0);
+	assert(gs != NULL);
 
-	st = initialize_new_stack();
-	pt = init_parse_tree(starting_symbol);
-	current_tree = pt->root;
-	printf("Parse tree at address: %p - %p\n", current_tree, pt);
+	st = gs->st;
+	work_tree = gs->pt;
+	reset_stack(st);
+	if(work_tree != NULL)
+	{
+		parse_tree_reset(work_tree, starting_symbol);
+		current_tree = work_tree->root;
+		current_tree->expanded = 1;
+	}
 
 	push(st, starting_symbol);
 	current = pop(st);
 
-	int added_rules = 0;
 	while(current != 0)
 	{	
 		symbol_list_entry *sle = NULL;
@@ -134,55 +151,59 @@ grow(symbol_id starting_symbol, symbol_list_entry *symbol_table)
 
 		if(is_NT(sle) == 1)
 		{
-			sle->visited--;
 			if(added_rules < GENERATION_THRESHOLD){
-				rle = get_random_rle(sle);
+				rle = get_random_rle(gs, sle);
 				added_rules++;
 			}
 			else
-				rle = get_terminal_rle(sle);
+			{
+				/*PAST THE THRESHOLD, CLOSE THE SENTENCE AS SOON AS POSSIBLE*/
+				rle = get_shortest_rle(sle, symbol_table);
+			}
 			
 			assert(rle != NULL);
-			push_rule_on_stack(st, rle, symbol_table, current_tree);
+			push_rule_on_stack(st, rle, symbol_table, work_tree, current_tree);
 			
 		}
 		else
 		{
-			generate_terminal_text(sle);
+			generate_terminal_text(gs, sle, symbol_table);
 
-			if(no_spaces_flag == 0){
-				generate_blank_text();
+			if(ctx->no_spaces_flag == 0){
+				generate_blank_text(gs);
 			}
-			current_tree = get_current_tree(current_tree);
 		}
 
 		current = pop(st);
-		current_tree = get_current_tree(current_tree);
-		/*
-		TODO: find a way to update 'current_tree' properly
-		maybe a valid solution could be keeping a reference to the parent into the parse tree struct and
-		when a terminal value is reached, marking the node as visisted and go into the next not visited into the 
-		children list of the parent
-		*/
-		//current_tree = current_tree->children[current_tree->num_children - 1];
+		/*KEEP current_tree ON THE NODE OF THE SYMBOL JUST POPPED*/
+		if(current_tree != NULL && current != 0)
+		{
+			current_tree = get_current_tree(current_tree);
+			assert(current_tree != NULL);
+			assert(current_tree->sym == current);
+		}
+	}
+
+	if(must_print_message(GENERATION))
+	{
+		fprintf(message_stream, "returning from Grow, random rules used: %d\n", added_rules);
 	}
-	printf("\nNumber of pushed rules: %d\n", added_rules);
-	printf("\n");
-	print_tree(pt->root,symbol_table);
-	clean_stack(st);
-	parse_tree_clean(pt);
 }
 
 
 
 /*PUSH ALL SYMBOLS IN RULE rle IN STACK st, FROM RIGHT TO LEFT*/
+/*THE visited FIELDS OF THE GRAMMAR ARE LEFT UNTOUCHED            */
+/*IF tree IS NOT NULL, THE SYMBOLS ARE ALSO ADDED AS ITS CHILDREN IN pt*/
 void
-push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_table, tree_node *tree)
+push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_table, parse_tree *pt, tree_node *tree)
 {
 	int i;
 
 	assert(st != NULL);
 	assert(rle != NULL);
+	/*GENERATION ONLY RUNS ON THE COMPILED GRAMMAR IMAGE*/
+	assert(rle->rhs != NULL);
 
 	symbol_id the_syms[rle->length];
 
@@ -191,7 +212,7 @@ push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_ta
 		symbol_id s = (symbol_id) 0;
 		symbol_list_entry *sle = NULL;
 
-		s = extract_symbol_rle(rle,i);
+		s = rle->rhs[i];
 		assert(s != (symbol_id) 0);
 
 		sle = get_symbol(symbol_table, s);
@@ -202,17 +223,14 @@ push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_ta
 			the_syms[i]=s;
 		}
 
-		if(is_NT(sle) == 1)
-		{
-			sle->visited++;
-		}
-
 		push(st, s);
 	}
 
 	if(tree!=NULL){
+		assert(pt != NULL);
+		tree_node_reserve_children(pt, tree, rle->length);
 		for (i=0; i < rle->length; i++){
-			tree_node_push_child(tree, the_syms[i]);
+			tree_node_push_child(pt, tree, the_syms[i]);
 		}
 	}
 }
@@ -222,9 +240,16 @@ push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_ta
 /*IMPLEMENTATION OF THE PURDOM ALGORITHM                                */
 /*GENERATES A SINGLE SINTACTICALLY VALID SENTENCE IN THE TARGET GRAMMAR */
 /*IN A SET OF SENTENCES WHICH COVER ALL RULES OF THE TARGET GRAMMAR     */
+/*gs IS USED AS IN grow(), BUT NO PARSE TREE IS BUILT. UNLIKE grow(),  */
+/*THE COVERAGE TABLE OF ctx (SEE coverage.c) AND, UNLESS IT IS THE     */
+/*TABLE OF A WORKER THREAD, THE visited FIELDS OF THE RULES ARE UPDATED*/
+/*EVERY SENTENCE COVERS AT LEAST ONE RULE                              */
 void
-purdom(symbol_id starting_symbol, symbol_list_entry *symbol_table)
+purdom(generator_context *ctx, generation_state *gs)
 {
+	symbol_id starting_symbol = ctx->starting_symbol;
+	symbol_list_entry *symbol_table = ctx->symbol_table;
+	grammar_image *image = symbol_table->index->image;
 	stack *st;
 	symbol_id current = (symbol_id) 0;
 	
@@ -235,16 +260,23 @@ purdom(symbol_id starting_symbol, symbol_list_entry *symbol_table)
 	}
 
 	assert(starting_symbol != (symbol_id) 0);
+	assert(gs != NULL);
+	assert(ctx->coverage != NULL);
 
-	st = initialize_new_stack();
+	st = gs->st;
+	reset_stack(st);
+	prepare_coverage_sentence(ctx->coverage, symbol_table);
 
-	push(st, starting_symbol);
+	push(st, PACK_POSITION(starting_symbol, image->rhs_size));
 	
 	current = pop(st);
 	while(current != 0)
 	{	
 		symbol_list_entry *sle = NULL;
 		rule_list_entry *rle = NULL;
+		int position = PACKED_POSITION(current);
+
+		current = PACKED_SYMBOL(current);
 
 		/*OPTIONAL MESSAGE PRINTING FOR EXECUTION TRACING*/
 		if(must_print_message(GENERATION))
@@ -257,34 +289,40 @@ purdom(symbol_id starting_symbol, symbol_list_entry *symbol_table)
 
 		if(is_NT(sle) == 1)
 		{
-			rle = choose(sle, symbol_table);
-			assert(rle != NULL);
+			int i;
 
-			rle->visited++;
-			sle->visited--;
+			rle = choose(ctx->coverage, sle, symbol_table, position);
+			assert(rle != NULL);
 
-			push_rule_on_stack(st, rle, symbol_table, NULL);
+			cover_rule(ctx->coverage, symbol_table, rle, position);
+			for(i = rle->length - 1; i >= 0; i--)
+			{
+				push(st, PACK_POSITION(rle->rhs[i], (int)(rle->rhs - image->rhs) + i));
+			}
 		}
 		else
 		{
-			generate_terminal_text(sle);
+			generate_terminal_text(gs, sle, symbol_table);
 
-			if(no_spaces_flag == 0)
-				generate_blank_text();
+			if(ctx->no_spaces_flag == 0)
+				generate_blank_text(gs);
 		}
 
 		current = pop(st);
 	}
-
-	clean_stack(st);
 }
 
 
 
-/*IMPLEMENTATION OF 'CHOOSE' ALGORITHM            */
-/*RETURNS THE RULE TO BE USED, NEVER RETURNS NULL */
+/*IMPLEMENTATION OF 'CHOOSE' ALGORITHM                         */
+/*RETURNS THE RULE FOR sle IN POSITION position: WITH PAIR     */
+/*COVERAGE, A RULE MAKING A NEW PAIR WITH THE RULE OF THE      */
+/*POSITION, OTHERWISE THE RULE PLANNED FOR sle IN THE CURRENT  */
+/*SENTENCE BY prepare_coverage_sentence(), OR THE RULE WHICH   */
+/*PRODUCES THE SHORTEST SENTENCE IN TERMS OF NUMBER OF LEXICAL */
+/*UNITS. NEVER RETURNS NULL                                    */
 rule_list_entry 
-*choose(symbol_list_entry *sle, symbol_list_entry *symbol_table)
+*choose(coverage_table *ct, symbol_list_entry *sle, symbol_list_entry *symbol_table, int position)
 {
 	rule_list_entry *r = NULL;
 	
@@ -293,37 +331,17 @@ rule_list_entry
 		fprintf(message_stream, "called Choose for symbol: %s (%d)...\n", sle->name, sle->id);
 	}
 
+	assert(ct != NULL);
 	assert(sle != NULL);
 	assert(symbol_table != NULL);
 	assert(is_NT(sle));
 
-	/*IF THE SYMBOL HAS ONLY ONE RULE, RETURN IT */
-	/*SMALL PERFORMANCE HACK                     */
-	if(sle->rulecount == 1)
+	r = get_uncovered_pair_rle(ct, symbol_table, position);
+	if(r == NULL && ct->once[sle->id] >= 0)
 	{
-		r = get_rle(sle, 1);
-		assert(r != NULL);
-
-		if(must_print_message(GENERATION))
-		{
-			fprintf(message_stream, "...Choose returning the only rule (address): %p\n", r);
-		}
-		return r;
+		r = &(symbol_table->index->image->rules[ct->once[sle->id]]);
 	}
-
-	/*TRY TO FIND AN UNVISITED RULE*/
-	r = get_unvisited_rle(sle);
-
-	/*IF IT HASN'T BEEN FOUND, TRY TO FIND A RULE               */
-	/*WHICH EVENTUALLY PRODUCES A SYMBOL WITH AN UNVISITED RULE */
-	if(r == NULL)
-	{
-		r = get_with_deep_unvisited_rle(sle, symbol_table);
-	}
-
-	/*IF IT HASN'T BEEN FOUND, USE THE RULE WHICH PRODUCES      */
-	/*THE SHORTEST SENTENCE IN TERMS OF NUMBER OF LEXICAL UNITS */
-	if(r == NULL)
+	else if(r == NULL)
 	{
 		r = get_shortest_rle(sle, symbol_table);
 	}
@@ -338,163 +356,38 @@ rule_list_entry
 }
 
 
-/*FINDS AN UNVISITED RLE FROM SYMBOL sle AND RETURN IT */
-/*RETURNS NULL IF ALL RLE IN SYMBOL HAVE BEEN VISITED  */
-rule_list_entry *
-get_unvisited_rle(symbol_list_entry *sle)
-{
-	int i;
-	
-	assert(sle != NULL);
-	assert(is_NT(sle) == 1);
-	assert(sle->rulecount != 0);
-
-	/*LOOK FOR THE FIRST UNVISITED RULE */
-	for(i=1; i <= sle->rulecount; i++)
-	{
-		rule_list_entry *rle;
-		
-		rle = get_rle(sle, i);
-		assert(rle != NULL);
-
-		if(rle->visited == 0)
-		{
-			return rle;
-		}
-	}
-	return NULL;
-}
-
-
-/*FINDS "rle" IN sle WHICH DERIVES A SYMBOL NOT IN THE STACK*/
-/*WHICH HAS AN UNVISITED "rle"                              */
-/*RETURNS NULL IF IT FAILS TO FIND ONE                      */
-rule_list_entry *
-get_with_deep_unvisited_rle(symbol_list_entry *sle, symbol_list_entry *symbol_table)
-{
-	int j, save_visited_value;	
-
-	assert(sle != NULL);
-	assert(symbol_table != NULL);
-	assert(is_NT(sle) != 0);
-
-	/*MARK THE SYMBOL AS VISITED TO SIMULATE PRESENCE ON THE STACK    */
-	/*THE OLD VALUE SHOULD BE KEPT AND REASSIGNED BEFORE RETURN. THIS */
-	/*IS BECAUSE THE FUNCTION IS CALLED BY choose() WHICH IS CALLED   */
-	/*BY purdom(), WHICH USES THE 'visited' FIELD AS A COUNTER        */
-	save_visited_value = sle->visited;
-	sle->visited = 1;
-
-	/*FOR EVERY RULE IN SYMBOL sle ...*/
-	for(j = 1; j <= sle->rulecount; j++)
-	{
-		int i;
-		rule_list_entry *rle_to_check = NULL;
-		
-		rle_to_check = get_rle(sle, j);
-		assert(rle_to_check != NULL);	
-
-		/*FOR EVERY SYMBOL IN RULE rle_to_check...*/
-		for(i=0; i < rle_to_check->length; i++)
-		{
-			symbol_id sle_to_check_id = 0;
-			symbol_list_entry *sle_to_check = NULL;
-			rule_list_entry *check_result = NULL;
-
-			sle_to_check_id = extract_symbol_rle(rle_to_check, i);
-			assert(sle_to_check_id != 0);
-			sle_to_check = get_symbol(symbol_table, sle_to_check_id);
-			assert(sle_to_check != NULL);
-
-			/*WE DON'T CARE ABOUT TERMINAL SYMBOLS*/
-			if(is_NT(sle_to_check) == 0)
-			{
-				continue;
-			}
-			/*NOR SYMBOLS ON THE STAACK*/
-			if(sle_to_check->visited != 0)
-			{
-				continue;
-			}
-			/*SEE IF THE SYMBOL HAS AN UNVISITED RULE, IN CASE RETURN IT*/
-			check_result = get_unvisited_rle(sle_to_check);
-			if(check_result != NULL)
-			{
-				sle->visited = save_visited_value;
-				return rle_to_check;
-			}
-		}
-
-		/*SO sle DOES NOT HAVE RULES WHICH DERIVE SYMBOLS  */
-		/*CONTAINING UNVISITED RULES.                      */
-		/*WE SHOULD CHECK IF ANY OF THE NT SYMBOLS IN SOME */
-		/*RULE OF Sle DO. RECRSION OCCURS                  */
-		for(i=0; i < rle_to_check->length; i++)
-		{
-			symbol_id sle_to_check_id = 0;
-			symbol_list_entry *sle_to_check = NULL;
-			rule_list_entry *check_result = NULL;
-
-			sle_to_check_id = extract_symbol_rle(rle_to_check, i);
-			assert(sle_to_check_id != 0);
-			sle_to_check = get_symbol(symbol_table, sle_to_check_id);
-			assert(sle_to_check != NULL);
-
-			if(is_NT(sle_to_check) == 0)
-			{
-				continue;
-			}
-			if(sle_to_check->visited != 0)
-			{
-				continue;
-			}
-
-			check_result = get_with_deep_unvisited_rle(sle_to_check, symbol_table);
-			if(check_result != NULL)
-			{
-				sle->visited = save_visited_value;
-				return rle_to_check;
-			}
-		}
-	}
-
-	/*WE HAD NO LUCK SO RETURN NULL*/
-	sle->visited = save_visited_value;
-	return NULL;
-}
-
-
-/*GETS A RANDOM RLE FROM SYMBOL sle*/
+/*GETS A RANDOM RLE FROM SYMBOL sle                           */
+/*IN CONSTANT TIME, FROM THE ALIAS TABLE OF sle: A RULE IS    */
+/*PICKED UNIFORMLY, THEN EITHER KEPT OR REPLACED BY IT'S ALIAS*/
 rule_list_entry *
-get_random_rle(symbol_list_entry *sle)
+get_random_rle(generation_state *gs, symbol_list_entry *sle)
 {
 	unsigned int rand_num = 0;
 	int i = 0;
+	rule_list_entry *rle = NULL;
 
 	assert(sle != NULL);
 	assert(is_NT(sle) == 1);
 	assert(sle->rulecount != 0);
 	
-	/*GET A RANDOM UNSIGNED INTEGER*/
-	rand_num = (unsigned int) (random() % UINT_MAX);
-
-	/*THE 'rle' LIST STRUCTURE OF sle CONTAINES THE NUMERICAL */
-	/*REPARTITION FUNCTION OF THE PROBABILITY DISTRIBUTION OF */
-	/*THE RULES                                               */
-	for(i=1; i <= sle->rulecount; i++)
+	/*THE ONLY RULE IS ALWAYS KEPT*/
+	if(sle->rulecount == 1)
 	{
-		rule_list_entry *rle = NULL;
+		return get_rle(sle, 1);
+	}
 
-		rle = get_rle(sle, i);
-		assert(rle != NULL);
+	i = (int)(generation_random(gs) % sle->rulecount);
+	rle = get_rle(sle, i + 1);
+	assert(rle != NULL);
 
-		if(rand_num <= rle->probability)
-		{
-			return rle;
-		}
+	/*GET A RANDOM UNSIGNED INTEGER BELOW 2^31*/
+	rand_num = (unsigned int) generation_random(gs);
+	if(rand_num < rle->alias_threshold)
+	{
+		return rle;
 	}
-	/*THIS SHOULD NOT HAPPEN*/
-	return NULL;
+
+	return get_rle(sle, rle->alias + 1);
 }
 
 /*GETS A RULE THAT EXPANDS IN ATERMINAL SYMBOL*/
@@ -519,189 +412,92 @@ get_terminal_rle(symbol_list_entry *sle){
 }
 
 
-/*RETURNS THE MINIMAL LENGTH OF SENTENCES DERIVING FROM rle*/
-/*RETURNS A NEGATIVE VALUE IF A SYMBOL IN rle IS FOUND TO BE ON THE STACK*/
-/*THIS IS BECAUSE A RECURSIVE RULE SURELY DOES NOT DERIVE THE SORTEST SENTENCE*/
+/*RETURNS THE MINIMAL LENGTH OF SENTENCES DERIVING FROM rle             */
+/*READ FROM THE TABLE BUILT BY compute_minimal_lengths(). RETURNS INT_MAX*/
+/*IF THE RULE DOES NOT DERIVE ANY SENTENCE                               */
 int
 rle_minimal_length(rule_list_entry *rle, symbol_list_entry *symbol_table)
 {
-	int sum = 0, i;
-
 	assert(rle != NULL);
 	assert(symbol_table != NULL);
 
-	/*FOR ALL SYMBOLS IN RULE rle...*/
-	for(i = 0; i < rle->length; i++)
-	{
-		symbol_list_entry *s = NULL;
-		symbol_id s_id = 0;
-
-		s_id = extract_symbol_rle(rle, i);
-		assert(s_id != 0);
-		s = get_symbol(symbol_table, s_id);
-		assert(s != NULL);
-
-		if(s->visited == -1)
-		{
-			return -1;
-		}
-
-		/*SUM UP ALL THE MINIMAL LENGTHS OF SYMBOLS CONTAINED BY rle */
-		sum += symbol_minimal_length(s, symbol_table);
-	}
-	return sum;
+	return symbol_table->index->image->rule_min_length[get_rule_index(symbol_table, rle)];
 }
 
 
 /*RETURNS THE MINIMAL LENGTH OF SENTENCES DERIVING FROM sle*/
+/*READ FROM THE TABLE BUILT BY compute_minimal_lengths()   */
 int
 symbol_minimal_length(symbol_list_entry *sle, symbol_list_entry *symbol_table)
 {
-	int i;
-	int shortest_value = INT_MAX, save_visited_value;
-
 	assert(sle != NULL);
 	assert(symbol_table != NULL);
 
-	/*BASIC CASE OF RECURSION: TERMINAL SYMBOLS PRODUCE ONE LEXICAL ITEM */
+	/*TERMINAL SYMBOLS PRODUCE ONE LEXICAL ITEM*/
 	if(is_NT(sle) == 0)
 	{
 		return 1;
 	}
-	
-	/*MARK sle TO SIMULATE 'STACK PRESENCE' CHECKING*/
-	/*FUNCTION WILL UNMARK sle BEFORE RETURNING     */
-	save_visited_value = sle->visited;
-	sle->visited = -1;
-
-	/*FOR EVERY RULE IN sle...*/
-	for(i = 1; i <= sle->rulecount; i++)
-	{
-		rule_list_entry *r = NULL;
-		int rml = INT_MAX;
 
-		r = get_rle(sle, i);
-		assert(r != NULL);
-
-		/*GET IT'S MINIMAL LENGTH SENTENCE LENGTH...*/
-		rml = rle_minimal_length(r, symbol_table);
-		
-		/*FIND THE MINIMUM POSITIVE VALUE AND RETURN IT*/
-		if(rml >= 0)
-		{
-			if(rml < shortest_value)
-			{
-				shortest_value = rml;
-			}
-		}
-		else
-			continue;
-	}
-
-	sle->visited = save_visited_value;
-	return shortest_value;
+	assert(symbol_table->index != NULL);
+	assert(symbol_table->index->image != NULL);
+	return symbol_table->index->image->min_length[sle->id];
 }
 
 
 /*RETURNS THE "rle" IN sle WHICH DERIVES THE SHORTEST SENTENCE*/
+/*IT IS CHOSEN ONCE FOR ALL SYMBOLS BY compute_minimal_lengths()*/
 rule_list_entry *
 get_shortest_rle(symbol_list_entry *sle, symbol_list_entry *symbol_table)
 {
-	int i;
-	int shortest_value = INT_MAX, save_visited_value;
-	rule_list_entry *shortest_rle = NULL;
-
 	assert(sle != NULL);
 	assert(symbol_table != NULL);
 	assert(is_NT(sle) != 0);
+	assert(sle->shortest != NULL);
 
-	/*IF 'SHORTEST' RULE ALREADY CHOSEN AND STORED, RETURN IT'S ADDRESS */
-	/*(PERFORMANCE HACK)*/
-	if(sle->shortest != NULL)
-	{
-		return sle->shortest;
-	}
-
-	/*MARK sle TO SIMULATE 'STACK PRESENCE' CHECKING */
-	/*FUNCTION WILL UNMARK sle BEFORE RETURNING      */
-	save_visited_value = sle->visited;
-	sle->visited = -1;
-
-	for(i = 1; i <= sle->rulecount; i++)
-	{
-		rule_list_entry *r = NULL;
-		int rml = INT_MAX;
-
-		r = get_rle(sle, i);
-		assert(r != NULL);
-
-		rml = rle_minimal_length(r, symbol_table);
-		
-		if(rml >= 0)
-		{
-			if(rml < shortest_value)
-			{
-				shortest_rle = r;
-				shortest_value = rml;
-			}
-		}
-		else
-			continue;
-	}
-	assert(shortest_rle != NULL);
-
-	/*STORE CALCULATED VALUE IN sle*/
-	sle->shortest = shortest_rle;
-
-	sle->visited = save_visited_value;
-	return shortest_rle;
+	return sle->shortest;
 }
 
 
 /*OUTPUT THE TEXT ASSOCIATED WITH A TERMINAL SYMBOL (LITERAL OR LEXICAL)*/
 void
-generate_terminal_text(symbol_list_entry *s)
+generate_terminal_text(generation_state *gs, symbol_list_entry *s, symbol_list_entry *symbol_table)
 {
+	grammar_image *image = NULL;
+
 	assert(s != NULL);
+	assert(symbol_table != NULL);
+	assert(symbol_table->index != NULL);
+	image = symbol_table->index->image;
+	assert(image != NULL);
 
-	/*LITERALS ARE ASSOCIATED WITH THEIR OWN NAME IN THE SYMBOL TABLE*/
-	if (is_LITERAL(s))
+	/*LITERALS, AND LEXICALS WITHOUT LEXICON, ARE PRINTED BY NAME:*/
+	/*THEIR BYTES HAVE BEEN DECODED BY compile_grammar()          */
+	if(image->text_offset[s->id] >= 0)
 	{
-		print_string(s->name);
+		write_output(gs, image->text + image->text_offset[s->id], image->text_length[s->id]);
 	}
-	/*LEXICALS ARE ASSOCIATED WITH A RANDOM ELEMENT OF THEIR LEXICON argz STRUCTURE*/
+	/*LEXICALS ARE ASSOCIATED WITH A RANDOM ELEMENT OF THEIR LEXICON,*/
+	/*DECODED BY add_lexical_unit()                                  */
 	else if(is_LEXICAL(s))
 	{
 		int num = 0;
+		int pos;
+		char *unit;
+		size_t length;
+		lexicon_structure *lex = NULL;
 
 		num = get_lexicon_numerosity(s);
+		assert(num != 0);
+		lex = (lexicon_structure *) s->rules;
+		assert(lex != NULL);
 
-		if(num != 0)
-		{
-			int pos;
-			char *point;
-
-			lexicon_argz_structure *lazs = NULL;
-
-			lazs = (lexicon_argz_structure *) s->rules;
-			assert(lazs != NULL);
-
-			pos = ((int)(random() % num));
-			point = lazs->argz;
-			/*NAVIGATE THE argz STRUCTURE TILL THE */
-			/*RANDOMLY SELECTED ELEMENT IS FOUND   */
-			while(pos-- > 0)
-			{
-				point = argz_next(lazs->argz, lazs->argz_size, point);
-			}
-
-			/*PASS THE POINTER TO PRINTING FUNCTION*/
-			print_string(point);
-		}
-
-		/*IN CASE NO STRUCTURE IS DEFINED (OR STRUCTURE EMPTY), NAME IS USED*/
-		else
-			print_string(s->name);
+		pos = ((int)(generation_random(gs) % num));
+		/*WEIGHTED LEXICONS: KEEP THE UNIT OR TAKE IT'S ALIAS, AS IN get_random_rle()*/
+		if(lex->alias != NULL && (unsigned int) generation_random(gs) >= lex->alias_threshold[pos])
+			pos = lex->alias[pos];
+		unit = get_lexicon_unit(lex, pos, &length);
+		write_output(gs, unit, length);
 	}
 	else if(is_UNDEFINED(s))
 	{
@@ -712,71 +508,66 @@ generate_terminal_text(symbol_list_entry *s)
 }
 
 
-/*OUTPUT STRING POINTED BY POINT (NULL TERMINATED), CONSIDERING ESCAPE SEQUENCES*/
-void
-print_string(char *point)
+/*WRITES IN dest THE BYTES OF STRING point (NULL TERMINATED), DECODING C */
+/*ESCAPE SEQUENCES, AND RETURNS THEIR NUMBER, WHICH IS NEVER GREATER THAN*/
+/*strlen(point). dest IS NOT NULL TERMINATED AND MAY CONTAIN NULL BYTES  */
+/*CALLED ONCE FOR EVERY TERMINAL NAME AND LEXICAL UNIT, WHILE LOADING    */
+size_t
+decode_escapes(char *point, char *dest)
 {
-	char c;
-	char *restart;
-	int escape = 0;
+	size_t length = 0;
 
 	assert(point != NULL);
+	assert(dest != NULL);
 
-	c = *point;
-	restart = point;
-
-	while(c != '\0')
+	while(*point != '\0')
 	{
-		/*ESCAPING CODE FOR STANDARD C ESCAPE SEQUENCES*/
-		if(escape == 1)
-		{
-			if(c == 'x')
-			{
-				long int ch;
+		char c = *point++;
 
-				ch = strtol(point + sizeof(char), &restart, 16);
+		if(c != '\\')
+		{
+			dest[length++] = c;
+		}
+		/*A TRAILING '\', ALONE, SHOULD BE PRINTED*/
+		else if(*point == '\0')
+		{
+			dest[length++] = '\\';
+		}
+		/*HEXADECIMAL ESCAPE: ALL THE HEX DIGITS WHICH FOLLOW*/
+		else if(*point == 'x' && isxdigit((unsigned char) point[1]))
+		{
+			unsigned int ch = 0;
 
-				putc((unsigned char) ch, output_stream);
-				point = restart;
-			}
-			else if(isdigit(c))
+			point++;
+			while(isxdigit((unsigned char) *point))
 			{
-				long int ch;
-
-				ch = strtol(point, &restart, 8);
-
-				putc((unsigned char) ch, output_stream);
-				point = restart;
+				ch = ch * 16 + (isdigit((unsigned char) *point)? *point - '0' : (tolower((unsigned char) *point) - 'a' + 10));
+				point++;
 			}
-			else
+			dest[length++] = (unsigned char) ch;
+		}
+		/*OCTAL ESCAPE: UP TO THREE OCTAL DIGITS*/
+		else if(*point >= '0' && *point <= '7')
+		{
+			unsigned int ch = 0;
+			int digits = 0;
+
+			while(digits < 3 && *point >= '0' && *point <= '7')
 			{
-				putc(get_escaped_char(c), output_stream);
-				escape = 0;
-				point += sizeof(char);
+				ch = ch * 8 + (*point - '0');
+				point++;
+				digits++;
 			}
+			dest[length++] = (unsigned char) ch;
 		}
 		else
 		{
-			if(c == '\\')
-			{
-				escape = 1;
-			}
-			else
-			{
-				fputc(c, output_stream);
-			}
-
-			point += sizeof(char);
+			dest[length++] = get_escaped_char(*point);
+			point++;
 		}
-
-		c = *point;
 	}
 
-	/*A TRAILING '\', ALONE, SHOULD BE PRINTED*/
-	if(escape == 1)
-	{
-		fputc('\\', output_stream);
-	}
+	return length;
 }
 
 
@@ -818,30 +609,30 @@ get_escaped_char(char c)
 
 /*GENERATES RANDOM SPACES, TABS AND NEWLINES ACCORDING TO TUNABLE PARAMETERS*/
 void
-generate_blank_text()
+generate_blank_text(generation_state *gs)
 {
 	unsigned short choose = 0, longer = 0;
 
-	longer = ((int)(random() % 100))+1;
-	choose = ((int)(random() % 100))+1;
+	longer = ((int)(generation_random(gs) % 100))+1;
+	choose = ((int)(generation_random(gs) % 100))+1;
 
 	if(longer <= MORE_BLANKS_PERCENTAGE)	
-		generate_blank_text();
+		generate_blank_text(gs);
 
 	if(choose <= NEWLINE_PROBABILITY_PERCENTAGE)
 	{
-		fputs("\n", output_stream);
+		write_output(gs, "\n", 1);
 	}
 	else if(choose <= TAB_PROBABILITY_PERCENTAGE + NEWLINE_PROBABILITY_PERCENTAGE)
 	{
-		fputs("\t", output_stream);
+		write_output(gs, "\t", 1);
 	}
 	else
 	{
 		unsigned short how_many;
 		
-		how_many = ((int)(random() % MAX_SPACES))+1;
-		while(how_many-- > 0)
-			fputs(" ", output_stream);
+		how_many = ((int)(generation_random(gs) % MAX_SPACES))+1;
+		memset(reserve_output(gs, how_many), ' ', how_many);
+		commit_output(gs, how_many);
 	}
 }
@@ -0,0 +1,554 @@
+/*
+image.c -- saving and loading of compiled grammar files
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <sys/stat.h>
+
+/*A COMPILED GRAMMAR FILE IS THE GRAMMAR IMAGE (SEE compile_grammar())  */
+/*WRITTEN AS IT IS IN MEMORY, SO THAT IT CAN BE MAPPED AND USED WITHOUT */
+/*PARSING OR CHECKING THE GRAMMAR AGAIN. IT IS MADE OF A HEADER FOLLOWED*/
+/*BY THESE SECTIONS, EACH ONE PADDED TO A MULTIPLE OF 8 BYTES:          */
+/*  - ONE image_symbol PER SYMBOL ID (SLOT 0 IS UNUSED)                 */
+/*  - THE NAMES OF THE SYMBOLS, NULL TERMINATED                         */
+/*  - ONE image_rule PER RULE, IN THE ORDER OF THE rules ARRAY          */
+/*  - THE ARRAYS rhs, rule_offset, rule_num, min_length, text_offset,   */
+/*    text_length, rule_lhs, rule_min_length AND text OF THE IMAGE      */
+/*  - FOR EVERY LEXICON, AN image_lexicon FOLLOWED BY IT'S TEXT, BY THE */
+/*    STARTS OF IT'S UNITS AND THE END OF THE LAST ONE AND, IF IT IS    */
+/*    WEIGHTED, BY THE WEIGHTS AND THE ALIAS TABLE                      */
+/*NUMBERS ARE IN THE BYTE ORDER OF THE MACHINE: THE FILE IS REJECTED BY */
+/*MACHINES WITH A DIFFERENT BYTE ORDER OR DIFFERENT TYPE SIZES. THE     */
+/*CHECKSUM OF THE HEADER IS THE 64 BIT FNV-1a HASH OF THE SECTIONS OF   */
+/*THE GRAMMAR, UP TO text, FOLLOWED BY THE HEADER ITSELF WITH A CHECKSUM*/
+/*OF 0. THE LEXICONS, WHICH CAN BE MUCH LARGER THAN THE GRAMMAR, ARE NOT*/
+/*SUMMED, SO THAT LOADING DOES NOT READ ALL OF THEM: THEIR INDEXES ARE  */
+/*CHECKED INSTEAD                                                       */
+
+#define IMAGE_BYTE_ORDER 0x01020304U
+#define IMAGE_ALIGNMENT 8
+#define IMAGE_CHECKSUM_BASIS 14695981039346656037ULL
+#define IMAGE_CHECKSUM_PRIME 1099511628211ULL
+
+typedef struct IMAGE_HEADER
+{
+	char magic[GRAMMAR_IMAGE_MAGIC_SIZE];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t symbol_id_size;
+	uint32_t size_t_size;
+	uint32_t symbol_count;
+	uint32_t starting_symbol;
+	uint32_t max_rules;
+	uint32_t lexicon_flag;
+	uint32_t lexicon_count;
+	uint32_t rule_count;
+	uint32_t rhs_size;
+	uint64_t names_size;
+	uint64_t text_size;
+	uint64_t file_size;
+	uint64_t checksum;
+} image_header;
+
+/*rulecount ENCODES THE TYPE OF THE SYMBOL, AS IN THE SYMBOL TABLE*/
+/*shortest IS A RULE INDEX, OR -1                                 */
+typedef struct IMAGE_SYMBOL
+{
+	int32_t rulecount;
+	int32_t visited;
+	int32_t shortest;
+	uint32_t name_offset;
+} image_symbol;
+
+/*THE RIGHT-HAND SIDE OF A RULE FOLLOWS THOSE OF THE PREVIOUS RULES*/
+typedef struct IMAGE_RULE
+{
+	int32_t length;
+	int32_t visited;
+	int32_t probability;
+	int32_t type;
+	uint32_t alias_threshold;
+	int32_t alias;
+} image_rule;
+
+typedef struct IMAGE_LEXICON
+{
+	uint64_t symbol;
+	uint64_t unit_count;
+	uint64_t text_size;
+	uint64_t weighted;
+	uint64_t lines;
+} image_lexicon;
+
+/*FILE BEING WRITTEN, NUMBER OF BYTES WRITTEN SO FAR AND THEIR CHECKSUM*/
+typedef struct IMAGE_WRITER
+{
+	FILE *f;
+	char *path;
+	uint64_t size;
+	uint64_t checksum;
+} image_writer;
+
+/*FILE BEING READ, AND POSITION OF THE NEXT SECTION*/
+typedef struct IMAGE_READER
+{
+	char *mapping;
+	uint64_t size;
+	uint64_t pos;
+	char *path;
+} image_reader;
+
+
+/*ADDS length BYTES FROM bytes TO THE CHECKSUM h*/
+static uint64_t
+update_checksum(uint64_t h, const void *bytes, size_t length)
+{
+	const unsigned char *b = bytes;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		h ^= b[i];
+		h *= IMAGE_CHECKSUM_PRIME;
+	}
+	return h;
+}
+
+
+/*WRITES length BYTES FROM bytes AS A SECTION OF THE FILE OF w*/
+static void
+write_section(image_writer *w, const void *bytes, size_t length)
+{
+	static const char padding[IMAGE_ALIGNMENT] = {0};
+	size_t pad = (IMAGE_ALIGNMENT - length % IMAGE_ALIGNMENT) % IMAGE_ALIGNMENT;
+
+	if(length > 0 && fwrite(bytes, 1, length, w->f) != length)
+		error(UNEXPECTED_ERROR, errno, "%s", w->path);
+	if(pad > 0 && fwrite(padding, 1, pad, w->f) != pad)
+		error(UNEXPECTED_ERROR, errno, "%s", w->path);
+	if(length > 0)
+		w->checksum = update_checksum(w->checksum, bytes, length);
+	w->checksum = update_checksum(w->checksum, padding, pad);
+	w->size += length + pad;
+}
+
+
+/*RETURNS THE NEXT SECTION OF THE FILE OF r, length BYTES LONG*/
+static void *
+read_section(image_reader *r, uint64_t length)
+{
+	char *section = NULL;
+
+	if(length > r->size - r->pos)
+		error(BAD_INPUT, 0, "%s: truncated compiled grammar", r->path);
+
+	section = r->mapping + r->pos;
+	r->pos += length;
+	r->pos += (IMAGE_ALIGNMENT - r->pos % IMAGE_ALIGNMENT) % IMAGE_ALIGNMENT;
+	if(r->pos > r->size)
+		r->pos = r->size;
+
+	return section;
+}
+
+
+/*RETURNS 1 IF THE FILE f STARTS AS A COMPILED GRAMMAR, 0 OTHERWISE*/
+/*THE FILE IS LEFT AT IT'S BEGINNING                              */
+int
+is_grammar_image_file(FILE *f)
+{
+	char magic[GRAMMAR_IMAGE_MAGIC_SIZE];
+	size_t n;
+
+	assert(f != NULL);
+
+	n = fread(magic, 1, GRAMMAR_IMAGE_MAGIC_SIZE, f);
+	rewind(f);
+
+	return (n == GRAMMAR_IMAGE_MAGIC_SIZE && memcmp(magic, GRAMMAR_IMAGE_MAGIC, GRAMMAR_IMAGE_MAGIC_SIZE) == 0)? 1:0;
+}
+
+
+/*WRITES THE COMPILED GRAMMAR OF ctx IN THE FILE path*/
+/*DOES NOT RETURN IN CASE OF ERRORS                  */
+void
+save_grammar_image(generator_context *ctx, char *path)
+{
+	int i, n;
+	image_header header;
+	image_writer w;
+	symbol_list_entry *work_sle = NULL;
+	grammar_image *image = NULL;
+	image_symbol *symbols = NULL;
+	image_rule *rules = NULL;
+	char *names = NULL;
+	size_t names_size = 0, text_size = 0;
+	uint64_t checksum;
+
+	assert(ctx != NULL);
+	assert(path != NULL);
+	work_sle = ctx->symbol_table;
+	assert(work_sle != NULL);
+	image = work_sle->index->image;
+	assert(image != NULL);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "saving compiled grammar in %s...\n", path);
+
+	n = work_sle->rulecount;
+	memset(&header, 0, sizeof(image_header));
+	memcpy(header.magic, GRAMMAR_IMAGE_MAGIC, GRAMMAR_IMAGE_MAGIC_SIZE);
+	header.version = GRAMMAR_IMAGE_VERSION;
+	header.byte_order = IMAGE_BYTE_ORDER;
+	header.symbol_id_size = sizeof(symbol_id);
+	header.size_t_size = sizeof(size_t);
+	header.symbol_count = n;
+	header.starting_symbol = ctx->starting_symbol;
+	header.max_rules = (unsigned short) work_sle->visited;
+	header.lexicon_flag = ctx->lexicon_flag;
+	header.rule_count = image->rule_count;
+	header.rhs_size = image->rhs_size;
+
+	/*SYMBOLS AND NAMES*/
+	symbols = xcalloc(n + 1, sizeof(image_symbol));
+	for(i = 1; i <= n; i++)
+	{
+		names_size += strlen(get_symbol(work_sle, i)->name) + 1;
+	}
+	names = xmalloc(names_size + 1);
+	names_size = 0;
+	for(i = 1; i <= n; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		size_t length = strlen(sle->name) + 1;
+
+		symbols[i].rulecount = sle->rulecount;
+		symbols[i].visited = sle->visited;
+		symbols[i].shortest = (is_NT(sle) && sle->shortest != NULL)? get_rule_index(work_sle, sle->shortest) : -1;
+		symbols[i].name_offset = names_size;
+		memcpy(names + names_size, sle->name, length);
+		names_size += length;
+
+		if(is_LEXICAL(sle) && sle->rules != NULL)
+			header.lexicon_count++;
+		if(image->text_offset[i] >= 0 && (size_t)(image->text_offset[i] + image->text_length[i]) > text_size)
+			text_size = image->text_offset[i] + image->text_length[i];
+	}
+	header.names_size = names_size;
+	header.text_size = text_size;
+
+	/*RULES*/
+	rules = xcalloc(image->rule_count + 1, sizeof(image_rule));
+	for(i = 0; i < image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(image->rules[i]);
+
+		rules[i].length = rle->length;
+		rules[i].visited = rle->visited;
+		rules[i].probability = rle->probability;
+		rules[i].type = rle->type;
+		rules[i].alias_threshold = rle->alias_threshold;
+		rules[i].alias = rle->alias;
+	}
+
+	w.f = fopen(path, "wb");
+	if(w.f == NULL)
+		error(BAD_ARGUMENTS, errno, "%s", path);
+	w.path = path;
+	w.size = 0;
+
+	/*THE HEADER IS WRITTEN AGAIN AT THE END, WITH THE SIZE OF THE FILE*/
+	/*AND THE CHECKSUM                                                 */
+	write_section(&w, &header, sizeof(image_header));
+	w.checksum = IMAGE_CHECKSUM_BASIS;
+	write_section(&w, symbols, (n + 1) * sizeof(image_symbol));
+	write_section(&w, names, names_size);
+	write_section(&w, rules, image->rule_count * sizeof(image_rule));
+	write_section(&w, image->rhs, image->rhs_size * sizeof(symbol_id));
+	write_section(&w, image->rule_offset, (n + 1) * sizeof(int));
+	write_section(&w, image->rule_num, (n + 1) * sizeof(int));
+	write_section(&w, image->min_length, (n + 1) * sizeof(int));
+	write_section(&w, image->text_offset, (n + 1) * sizeof(int));
+	write_section(&w, image->text_length, (n + 1) * sizeof(int));
+	write_section(&w, image->rule_lhs, image->rule_count * sizeof(symbol_id));
+	write_section(&w, image->rule_min_length, image->rule_count * sizeof(int));
+	write_section(&w, image->text, text_size);
+	checksum = w.checksum;
+
+	for(i = 1; i <= n; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		lexicon_structure *lex = NULL;
+		image_lexicon record;
+
+		if(is_LEXICAL(sle) == 0 || sle->rules == NULL)
+			continue;
+
+		lex = (lexicon_structure *) sle->rules;
+		memset(&record, 0, sizeof(image_lexicon));
+		record.symbol = sle->id;
+		record.unit_count = lex->unit_count;
+		record.text_size = lex->text_used;
+		record.weighted = (lex->unit_weight != NULL)? 1:0;
+		record.lines = lex->lines;
+
+		write_section(&w, &record, sizeof(image_lexicon));
+		write_section(&w, lex->text, lex->text_used);
+		write_section(&w, lex->unit_start, (lex->unit_count + 1) * sizeof(size_t));
+		if(record.weighted)
+		{
+			write_section(&w, lex->unit_weight, lex->unit_count * sizeof(unsigned int));
+			write_section(&w, lex->alias_threshold, lex->unit_count * sizeof(unsigned int));
+			write_section(&w, lex->alias, lex->unit_count * sizeof(int));
+		}
+	}
+
+	header.file_size = w.size;
+	header.checksum = 0;
+	header.checksum = update_checksum(checksum, &header, sizeof(image_header));
+	if(fseek(w.f, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(image_header), 1, w.f) != 1)
+		error(UNEXPECTED_ERROR, errno, "%s", path);
+	if(fclose(w.f) != 0)
+		error(UNEXPECTED_ERROR, errno, "%s", path);
+
+	free(symbols);
+	free(names);
+	free(rules);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "...done: %lu bytes\n", (unsigned long) header.file_size);
+}
+
+
+/*BUILDS THE GRAMMAR OF ctx FROM IT'S INPUT STREAM, WHICH IS A COMPILED*/
+/*GRAMMAR FILE. THE FILE IS MAPPED IN MEMORY, AND ONLY THE SYMBOL TABLE */
+/*AND THE RULES ARE BUILT FROM IT: ALL OTHER ARRAYS OF THE IMAGE AND OF */
+/*THE LEXICONS STAY IN THE MAPPING. A FILE WITH A WRONG CHECKSUM, OR   */
+/*WHOSE INDICES AND COUNTS DO NOT MATCH, IS REJECTED AS CORRUPTED      */
+/*DOES NOT RETURN IN CASE OF ERRORS                                     */
+void
+load_grammar_image(generator_context *ctx)
+{
+	int i, j, n;
+	struct stat st;
+	image_reader r;
+	image_header *header = NULL;
+	image_symbol *symbols = NULL;
+	image_rule *rules = NULL;
+	char *names = NULL;
+	symbol_list_entry *work_sle = NULL;
+	grammar_image *image = NULL;
+	image_header unsummed;
+	uint64_t rhs_pos = 0, grammar_pos, checksum, k;
+	int linked = 0;
+
+	assert(ctx != NULL);
+	assert(ctx->input_grammar_stream != NULL);
+	assert(ctx->symbol_table == NULL);
+
+	use_generator_context(ctx);
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "loading compiled grammar...\n");
+
+	r.path = ctx->input_grammar_file_path;
+	if(fstat(fileno(ctx->input_grammar_stream), &st) != 0)
+		error(UNEXPECTED_ERROR, errno, "%s", r.path);
+	if((size_t) st.st_size < sizeof(image_header))
+		error(BAD_INPUT, 0, "%s: truncated compiled grammar", r.path);
+
+	r.mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(ctx->input_grammar_stream), 0);
+	if(r.mapping == MAP_FAILED)
+		error(UNEXPECTED_ERROR, errno, "%s", r.path);
+	r.size = st.st_size;
+	r.pos = 0;
+
+	/*THE HEADER*/
+	header = read_section(&r, sizeof(image_header));
+	if(header->version != GRAMMAR_IMAGE_VERSION)
+		error(BAD_INPUT, 0, "%s: compiled grammar has version %u, version %d expected: compile the grammar again", r.path, header->version, GRAMMAR_IMAGE_VERSION);
+	if(header->byte_order != IMAGE_BYTE_ORDER || header->symbol_id_size != sizeof(symbol_id) || header->size_t_size != sizeof(size_t))
+		error(BAD_INPUT, 0, "%s: compiled grammar was written on an incompatible machine", r.path);
+	if(header->file_size != r.size)
+		error(BAD_INPUT, 0, "%s: truncated compiled grammar", r.path);
+	if(header->symbol_count > INT_MAX - 1 || header->starting_symbol == 0 || header->starting_symbol > header->symbol_count)
+		error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	n = header->symbol_count;
+
+	image = xcalloc(1, sizeof(grammar_image));
+	image->mapping = r.mapping;
+	image->mapping_size = r.size;
+	image->rule_count = header->rule_count;
+	image->rhs_size = header->rhs_size;
+
+	grammar_pos = r.pos;
+	symbols = read_section(&r, (n + 1) * sizeof(image_symbol));
+	names = read_section(&r, header->names_size);
+	rules = read_section(&r, header->rule_count * sizeof(image_rule));
+	image->rhs = read_section(&r, header->rhs_size * sizeof(symbol_id));
+	image->rule_offset = read_section(&r, (n + 1) * sizeof(int));
+	image->rule_num = read_section(&r, (n + 1) * sizeof(int));
+	image->min_length = read_section(&r, (n + 1) * sizeof(int));
+	image->text_offset = read_section(&r, (n + 1) * sizeof(int));
+	image->text_length = read_section(&r, (n + 1) * sizeof(int));
+	image->rule_lhs = read_section(&r, header->rule_count * sizeof(symbol_id));
+	image->rule_min_length = read_section(&r, header->rule_count * sizeof(int));
+	image->text = read_section(&r, header->text_size);
+
+	memcpy(&unsummed, header, sizeof(image_header));
+	unsummed.checksum = 0;
+	checksum = update_checksum(IMAGE_CHECKSUM_BASIS, r.mapping + grammar_pos, r.pos - grammar_pos);
+	if(update_checksum(checksum, &unsummed, sizeof(image_header)) != header->checksum)
+		error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	if(header->names_size == 0 || names[header->names_size - 1] != '\0')
+		error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	for(i = 0; i < image->rhs_size; i++)
+	{
+		if(image->rhs[i] == 0 || image->rhs[i] > (symbol_id) n)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	}
+	for(i = 1; i <= n; i++)
+	{
+		if(image->text_offset[i] >= 0 && (image->text_length[i] < 0 || (uint64_t)(image->text_offset[i] + image->text_length[i]) > header->text_size))
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	}
+
+	/*THE SYMBOL TABLE*/
+	work_sle = initialize_new_symbol_list();
+	for(i = 1; i <= n; i++)
+	{
+		symbol_list_entry *sle = NULL;
+
+		if(symbols[i].name_offset >= header->names_size)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+		insert_symbol(work_sle, names + symbols[i].name_offset, UNDEFINED);
+		sle = get_symbol(work_sle, i);
+		sle->rulecount = symbols[i].rulecount;
+		sle->visited = symbols[i].visited;
+	}
+	work_sle->visited = header->max_rules;
+	work_sle->index->image = image;
+	ctx->symbol_table = work_sle;
+	ctx->starting_symbol = header->starting_symbol;
+	ctx->lexicon_flag = header->lexicon_flag;
+
+	/*THE RULES, LINKED AS compile_grammar() DOES*/
+	image->rules = xcalloc(image->rule_count + 1, sizeof(rule_list_entry));
+	for(i = 0; i < image->rule_count; i++)
+	{
+		rule_list_entry *rle = &(image->rules[i]);
+
+		if(rules[i].length < 0 || (uint64_t) rules[i].length > image->rhs_size - rhs_pos)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		if(rules[i].type < UNRECOGNIZED || rules[i].type > ALIAS)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+		rle->rhs = &(image->rhs[rhs_pos]);
+		rle->length = rules[i].length;
+		rle->visited = rules[i].visited;
+		rle->probability = rules[i].probability;
+		rle->type = rules[i].type;
+		rle->alias_threshold = rules[i].alias_threshold;
+		rle->alias = rules[i].alias;
+		rhs_pos += rules[i].length;
+	}
+	if(rhs_pos != (uint64_t) image->rhs_size)
+		error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+	for(i = 1; i <= n; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+		int first = image->rule_offset[i], num = image->rule_num[i];
+
+		if(is_NT(sle) == 0 && num != 0)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		if(is_NT(sle) == 0 || num == 0)
+			continue;
+		if(first < 0 || num != sle->rulecount || first > image->rule_count - num)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		if(symbols[i].shortest < first || symbols[i].shortest >= first + num)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+		/*THE ALIAS OF A RULE IS THE INDEX OF ANOTHER RULE OF IT'S SYMBOL*/
+		/*(SEE get_random_rle())                                        */
+		for(j = first; j < first + num; j++)
+		{
+			if(image->rule_lhs[j] != (symbol_id) i || image->rules[j].alias < 0 || image->rules[j].alias >= num)
+				error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+			if(j < first + num - 1)
+				image->rules[j].next = &(image->rules[j + 1]);
+		}
+		sle->rules = &(image->rules[first]);
+		sle->shortest = &(image->rules[symbols[i].shortest]);
+		linked += num;
+	}
+	if(linked != image->rule_count || get_symbol(work_sle, ctx->starting_symbol)->rules == NULL)
+		error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+	/*THE LEXICONS*/
+	for(i = 0; i < (int) header->lexicon_count; i++)
+	{
+		image_lexicon *record = NULL;
+		lexicon_structure *lex = NULL;
+		symbol_list_entry *sle = NULL;
+
+		record = read_section(&r, sizeof(image_lexicon));
+		if(record->symbol == 0 || record->symbol > (uint64_t) n)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		sle = get_symbol(work_sle, record->symbol);
+		if(is_LEXICAL(sle) == 0 || sle->rules != NULL || (uint64_t) get_lexicon_numerosity(sle) != record->unit_count)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+
+		lex = initialize_new_lexicon_structure();
+		lex->mapped = 2;
+		lex->unit_count = lex->unit_size = (int) record->unit_count;
+		lex->text_size = lex->text_used = record->text_size;
+		lex->text = read_section(&r, record->text_size);
+		lex->lines = (record->lines != 0)? 1:0;
+		lex->unit_start = read_section(&r, (record->unit_count + 1) * sizeof(size_t));
+		if(record->weighted != 0)
+		{
+			lex->unit_weight = read_section(&r, record->unit_count * sizeof(unsigned int));
+			lex->alias_threshold = read_section(&r, record->unit_count * sizeof(unsigned int));
+			lex->alias = read_section(&r, record->unit_count * sizeof(int));
+		}
+		if(lex->unit_start[record->unit_count] > record->text_size)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		for(k = 0; k < record->unit_count; k++)
+		{
+			if(lex->unit_start[k] > lex->unit_start[k + 1])
+				error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+			if(lex->alias != NULL && (lex->alias[k] < 0 || (uint64_t) lex->alias[k] >= record->unit_count))
+				error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+		}
+		sle->rules = (rule_list_entry *) lex;
+	}
+
+	/*A LEXICAL SYMBOL WITHOUT A NAME TO PRINT MUST HAVE IT'S LEXICON*/
+	for(i = 1; i <= n; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		if(is_LEXICAL(sle) != 0 && image->text_offset[i] < 0 && sle->rules == NULL)
+			error(BAD_INPUT, 0, "%s: corrupted compiled grammar", r.path);
+	}
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "...done: %d symbols, %d rules, %u lexicons\n", n, image->rule_count, header->lexicon_count);
+}
@@ -25,13 +25,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <getopt.h>
 #include <ctype.h>
 #include <error.h>
 #include <errno.h>
 #include <limits.h>
-#include <argz.h>
+#include <stdint.h>
+#include <sys/mman.h>
 
 #include <lexicon_scanner_tokens.h>
 
@@ -45,6 +47,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define GENERATION_THRESHOLD 3
 #define STACK_DEFAULT_SIZE 4
 #define PARSE_TREE_DEFAULT_CHILDREN_NUM 3
+#define PARSE_TREE_ARENA_CHUNK_SIZE 65536
+#define SYMBOL_INDEX_DEFAULT_SIZE 64
+#define SYMBOL_HASH_DEFAULT_SIZE 128
+#define NAME_ARENA_CHUNK_SIZE 4096
+#define ARENA_ALIGNMENT 16
+/*ALIAS THRESHOLD OF A RULE WHICH IS ALWAYS KEPT: random() IS BELOW 2^31*/
+#define ALIAS_THRESHOLD_ONE 2147483648U
+/*LARGEST WEIGHT OF A LEXICAL UNIT*/
+#define MAX_LEXICON_WEIGHT 1000000000UL
 
 /*COSTANTS FOR DEFAULT PROGRAM BEHAVIOR*/
 #define DEFAULT_VERBOSITY 6
@@ -59,6 +70,35 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define DEFAULT_PROBABILITY_INITIALIZATION 1
 #define DEFAULT_NULL_PATH "/dev/null"
 #define DEFAULT_MAX_RECURSION_DEPTH 10
+#define DEFAULT_TREE_MODE PRETTY_TREE
+#define DEFAULT_COVERAGE_CRITERION RULE_COVERAGE
+#define DEFAULT_JOBS 1
+/*SENTENCES GENERATED BY EVERY WORKER THREAD BEFORE OUTPUT IS WRITTEN*/
+#define BATCH_SENTENCES_PER_JOB 256
+/*SIZE WINDOW OF THE BOLTZMANN SAMPLER AROUND A SINGLE TARGET, IN PERCENT*/
+#define BOLTZMANN_TOLERANCE_PERCENTAGE 20
+/*SENTENCES REJECTED BY THE BOLTZMANN SAMPLER BEFORE GIVING UP*/
+#define BOLTZMANN_MAX_ATTEMPTS 1000000
+/*INITIAL SIZE OF THE OUTPUT BUFFER OF EVERY GENERATOR STATE*/
+#define OUTPUT_BUFFER_SIZE 65536
+/*INITIAL NUMBER OF SENTENCES AND OF RULES RECORDED FOR MINIMIZATION*/
+#define COVERAGE_RECORD_DEFAULT_SIZE 256
+/*COVERAGE SENTENCES GENERATED BY EVERY WORKER THREAD IN A ROUND*/
+#define COVERAGE_SENTENCES_PER_JOB 16
+/*FIRST BYTES AND FORMAT VERSION OF A COMPILED GRAMMAR FILE (SEE image.c)*/
+#define GRAMMAR_IMAGE_MAGIC "FORSONGI"
+#define GRAMMAR_IMAGE_MAGIC_SIZE 8
+#define GRAMMAR_IMAGE_VERSION 4
+/*FIRST WORD AND FORMAT VERSION OF A COVERAGE STATE FILE (SEE state.c)*/
+#define COVERAGE_STATE_MAGIC "FORSONCS"
+#define COVERAGE_STATE_VERSION 1
+
+/*BITSETS ARE ARRAYS OF unsigned long*/
+#define BITSET_WORD_BITS (8 * sizeof(unsigned long))
+#define BITSET_WORDS(n) (((n) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+#define BITSET_TEST(b, i) (((b)[(i) / BITSET_WORD_BITS] >> ((i) % BITSET_WORD_BITS)) & 1UL)
+#define BITSET_SET(b, i) ((b)[(i) / BITSET_WORD_BITS] |= 1UL << ((i) % BITSET_WORD_BITS))
+#define BITSET_CLEAR(b, i) ((b)[(i) / BITSET_WORD_BITS] &= ~(1UL << ((i) % BITSET_WORD_BITS)))
 
 /*DEFINING THE VERBOSITY POLICY AND THE SOURCES OF MESSAGES IN THE PROGRAM*/
 #define VERB_POLICY {1,2,4,4,3,4,6,5,0}
@@ -86,6 +126,8 @@ typedef enum {MAIN, PARSER, G_SCANNER, L_SCANNER, CLEAN_MIN, CLEAN_MAX, LISTOPS,
 typedef enum {UNRECOGNIZED, EMPTY, STANDARD, TERMINAL, RECURSIVE, LEFT_RECURSIVE, RIGHT_RECURSIVE, MULTIPLE_RECURSIVE, COPY, AUTO_COPY, ALIAS} rule_type;
 typedef enum {LEXICAL, LITERAL, NT, UNDEFINED, RANDOM_LEXICAL} symbol_type;
 typedef enum {NORMAL, BAD_ARGUMENTS, BAD_INPUT, UNEXPECTED_ERROR} exit_codes;
+typedef enum {NO_TREE, PRETTY_TREE, COMPACT_TREE} tree_mode;
+typedef enum {RULE_COVERAGE, PAIR_COVERAGE} coverage_criterion;
 
 /*UNIQUE IDENTIFIER FOR NON TERMINAL SYMBOLS*/
 typedef unsigned long symbol_id;
@@ -97,7 +139,7 @@ typedef symbol_id rule_t;
 /*TYPE FOR STACK IMPLEMENTATION*/
 typedef struct STK
 {
-	symbol_id **buffer;
+	symbol_id *buffer;
 	int size;
 	int stack_size;
 } stack;
@@ -107,10 +149,18 @@ typedef struct RBL
 {
 	struct RBL *next;
 	rule_t *rule;
+	/*ONCE THE GRAMMAR IS COMPILED, POINTS TO THE SYMBOLS OF THE RULE*/
+	/*IN THE GRAMMAR IMAGE (rule IS THEN NULL). NULL BEFORE THAT     */
+	symbol_id *rhs;
 	short length;
 	short visited;
 	int probability;
 	rule_type type;
+	/*ALIAS TABLE ENTRY, SEE build_alias_table(): THE RULE IS CHOSEN IF A   */
+	/*RANDOM VALUE IS BELOW alias_threshold, OTHERWISE THE RULE IN POSITION */
+	/*alias (COUNTING FROM ZERO) AMONG THOSE OF THE SAME SYMBOL IS CHOSEN   */
+	unsigned int alias_threshold;
+	int alias;
 } rule_list_entry;
 
 /*LIST TYPE FOR NON TERMINAL SYMBOL TABLE*/
@@ -129,15 +179,204 @@ typedef struct SL
 	short visited;
 	rule_list_entry *shortest;
 	rule_list_entry *rules;
+	/*IN THE HEAD NODE, POINTS TO THE DENSE SYMBOL INDEX. NULL IN ALL OTHER NODES*/
+	struct SIDX *index;
 } symbol_list_entry;
 
-/*TYPE FOR argz CONTAINER FOR LEXICON ELEMENTS READ FROM A LEXICAL INPUT FILE*/
-/*POINTED TO BY THE rules FIELD IN LEXICAL SYMBOLS                           */
+/*TYPES FOR THE CHUNKED BUMP ALLOCATOR (SEE arena.c)*/
+typedef struct ARENA_CHUNK
+{
+	struct ARENA_CHUNK *next;
+	size_t size;
+	size_t used;
+	char data[];
+} arena_chunk;
+
+typedef struct ARENA
+{
+	arena_chunk *first;
+	arena_chunk *current;
+	size_t chunk_size;
+} arena;
+
+/*SLOT OF THE OPEN ADDRESSING NAME HASH TABLE*/
+typedef struct SHSLOT
+{
+	unsigned long hash;
+	symbol_list_entry *sle;
+} symbol_hash_slot;
+
+/*DENSE INDEX OF THE SYMBOL TABLE, KEPT IN SYNC BY insert_symbol AND remove_sle*/
+/*symbols[id] POINTS TO THE NODE WITH SYMBOL ID id (SLOT 0 IS THE HEAD NODE)  */
+/*NAMES ARE INTERNED IN names AND HASHED IN THE OPEN ADDRESSING TABLE hash    */
+typedef struct SIDX
+{
+	symbol_list_entry **symbols;
+	int size;
+	symbol_hash_slot *hash;
+	int hash_size;
+	int hash_used;
+	arena *names;
+	struct GIMG *image;
+} symbol_index;
+
+/*COMPILED, READ-ONLY IMAGE OF THE GRAMMAR, BUILT BY compile_grammar()  */
+/*ONCE THE GRAMMAR HAS BEEN CHECKED. RULES OF A NON-TERMINAL ARE STORED */
+/*CONTIGUOUSLY, SO THAT THE rules FIELD OF THE SYMBOL POINTS TO AN ARRAY*/
+typedef struct GIMG
+{
+	/*RIGHT-HAND SIDES OF ALL RULES, BACK TO BACK*/
+	symbol_id *rhs;
+	int rhs_size;
+	/*ALL RULES, GROUPED BY NON-TERMINAL IN SYMBOL ID ORDER*/
+	rule_list_entry *rules;
+	int rule_count;
+	/*PER SYMBOL (INDEXED BY symbol_id): OFFSET OF THE FIRST RULE IN rules*/
+	/*AND NUMBER OF RULES. BOTH ARE ZERO FOR TERMINAL SYMBOLS             */
+	int *rule_offset;
+	int *rule_num;
+	/*PER RULE: THE NON-TERMINAL ON ITS LEFT-HAND SIDE*/
+	symbol_id *rule_lhs;
+	/*MINIMAL NUMBER OF LEXICAL UNITS DERIVABLE FROM EVERY SYMBOL (INDEXED */
+	/*BY symbol_id) AND FROM EVERY RULE, SEE compute_minimal_lengths()     */
+	int *min_length;
+	int *rule_min_length;
+	/*BYTES PRINTED FOR THE TERMINALS WHICH ARE PRINTED BY NAME, WITH ESCAPE */
+	/*SEQUENCES ALREADY DECODED. text_offset AND text_length ARE INDEXED BY  */
+	/*symbol_id; text_offset IS -1 FOR SYMBOLS WHICH ARE NOT PRINTED BY NAME */
+	char *text;
+	int *text_offset;
+	int *text_length;
+	/*WHEN THE IMAGE IS LOADED FROM A COMPILED GRAMMAR FILE, ALL ARRAYS BUT*/
+	/*rules POINT INTO THIS READ-ONLY MAPPING OF THE FILE. NULL OTHERWISE  */
+	void *mapping;
+	size_t mapping_size;
+} grammar_image;
+
+/*NUMBER OF DERIVATIONS OF EVERY LENGTH, UP TO max_length TOKENS, BUILT */
+/*BY build_length_table(). count[s * stride + n] IS THE NUMBER OF PARSE */
+/*TREES OF n TOKENS ROOTED IN SYMBOL s. FOR RULE r, WHOSE RIGHT-HAND    */
+/*SIDE STARTS AT rhs[o] IN THE GRAMMAR IMAGE, suffix[(o + r + j) * stride*/
+/*+ n] IS THE NUMBER OF DERIVATIONS OF n TOKENS FROM IT'S SYMBOLS FROM  */
+/*THE j-TH TO THE LAST (j MAY BE EQUAL TO THE LENGTH OF THE RULE)        */
+typedef struct LTAB
+{
+	int max_length;
+	int stride;
+	double *count;
+	double *suffix;
+	/*total[n - min_length]: SENTENCES OF THE STARTING SYMBOL WITH min_length*/
+	/*TO n TOKENS, FOR EVERY n UP TO max_length                             */
+	int min_length;
+	double *total;
+} length_table;
+
+/*TABLE OF THE PURDOM ALGORITHM, BUILT BY build_coverage_table(). ALL   */
+/*ARRAYS ARE INDEXED BY symbol_id. derivation_length IS THE NUMBER OF   */
+/*TOKENS OF THE SHORTEST SENTENCE WHOSE DERIVATION USES THE SYMBOL      */
+/*(INT_MAX IF THERE IS NONE), AND previous THE RULE INTRODUCING THE     */
+/*SYMBOL IN IT (-1 FOR THE STARTING SYMBOL). next_rule IS THE FIRST RULE*/
+/*OF THE SYMBOL WHICH MAY STILL BE UNCOVERED, AND once THE RULE TO BE   */
+/*USED BY IT'S NEXT EXPANSION IN THE CURRENT SENTENCE (-1 FOR THE       */
+/*SHORTEST ONE). RULES ARE INDEXES IN THE RULES OF THE GRAMMAR IMAGE    */
+/*pending LISTS THE REACHABLE SYMBOLS WHICH MAY STILL HAVE RULES TO BE  */
+/*COVERED, AND planned THE SYMBOLS WHOSE once FIELD HAS BEEN SET        */
+typedef struct COVT
+{
+	int *derivation_length;
+	int *previous;
+	int *next_rule;
+	int *once;
+	symbol_id *pending;
+	int pending_count;
+	symbol_id *planned;
+	int planned_count;
+	/*REACHABLE AND PRODUCTIVE RULES NOT COVERED YET, AND BITSET OF THE*/
+	/*RULES COVERED                                                    */
+	int uncovered;
+	unsigned long *covered_rules;
+	/*WHEN in_sentence IS NOT NULL, THE DISTINCT RULES USED BY EVERY     */
+	/*SENTENCE ARE RECORDED: THOSE OF THE j-TH ONE ARE sentence_rules[k] */
+	/*FOR sentence_offset[j] <= k < sentence_offset[j+1], FIRST USED IN  */
+	/*POSITION sentence_positions[k]. in_sentence IS THE BITSET OF THE   */
+	/*RULES USED BY THE CURRENT SENTENCE                                 */
+	unsigned long *in_sentence;
+	int *sentence_rules;
+	int *sentence_positions;
+	int sentence_rules_used;
+	int sentence_rules_size;
+	int *sentence_offset;
+	int sentences;
+	int sentence_offset_size;
+	/*PAIR COVERAGE (SEE build_pair_table()). THE ARRAYS ARE NULL WITH RULE */
+	/*COVERAGE. A POSITION IS AN INDEX IN THE rhs ARRAY OF THE GRAMMAR      */
+	/*IMAGE, OR rhs_size FOR THE STARTING SYMBOL. pair_group[k] IS THE FIRST*/
+	/*POSITION OF THE SAME SYMBOL IN THE SAME RULE AS k (-1 FOR TERMINALS), */
+	/*AND FOR THAT POSITION pair_base IS THE INDEX OF THE PAIR MADE WITH THE*/
+	/*FIRST RULE OF THE SYMBOL, pair_next THE FIRST RULE OF THE SYMBOL WHICH*/
+	/*MAY STILL MAKE A NEW PAIR. pair_parent[k] IS THE RULE OF POSITION k   */
+	/*(rule_count FOR THE STARTING SYMBOL), AND pair_pending[r] COUNTS THE  */
+	/*PAIRS NOT COVERED YET WHOSE PARENT IS RULE r                          */
+	int *pair_group;
+	int *pair_base;
+	int *pair_next;
+	int *pair_parent;
+	int *pair_pending;
+	unsigned long *covered_pairs;
+	int pair_count;
+	/*REACHABLE PAIRS OF PRODUCTIVE RULES NOT COVERED YET*/
+	int uncovered_pairs;
+	symbol_id starting_symbol;
+	/*THE TABLE OF A WORKER THREAD (SEE generate_coverage()) SHARES THE   */
+	/*READ-ONLY ARRAYS AND THE pending LIST OF THE MAIN TABLE, AND PLANS  */
+	/*ONLY IT'S OWN RULES, THOSE r WITH r % jobs == worker. own_rule AND  */
+	/*pair_own_next ARE THE CURSORS OF next_rule AND pair_next OVER THEM. */
+	/*jobs IS 0 FOR THE MAIN TABLE, THE ONLY ONE UPDATING THE visited     */
+	/*FIELDS OF THE GRAMMAR                                               */
+	int jobs;
+	int worker;
+	int *own_rule;
+	int *pair_own_next;
+	/*WITH RULE COVERAGE, THE PAIR KEYS READ BY load_coverage_state(),*/
+	/*WRITTEN BACK UNCHANGED BY save_coverage_state()                 */
+	uint64_t *kept_pair_keys;
+	int kept_pair_count;
+} coverage_table;
+
+/*ENTRY OF THE PRIORITY QUEUE USED BY compute_minimal_lengths() AND BY*/
+/*build_coverage_table()                                              */
+typedef struct MLQ
+{
+	int length;
+	int rule;
+} min_length_queue_entry;
+
+/*LEXICON OF A LEXICAL SYMBOL, READ FROM A LEXICAL INPUT FILE AND POINTED */
+/*TO BY THE rules FIELD OF THE SYMBOL. UNITS ARE STORED BACK TO BACK IN   */
+/*text, WITH ESCAPE SEQUENCES ALREADY DECODED; THE pos-TH UNIT STARTS AT  */
+/*unit_start[pos] AND ENDS WHERE THE NEXT ONE STARTS, AT unit_start[pos+1]*/
+/*(IT MAY CONTAIN NULL BYTES AND IS NOT NULL TERMINATED). unit_weight IS  */
+/*NULL WHILE ALL UNITS HAVE WEIGHT 1; OTHERWISE alias_threshold AND alias */
+/*ARE THE ALIAS TABLE OF THE WEIGHTS, SEE build_lexicon_alias_table(). THE*/
+/*LEXICON OF A WORD LIST (SEE load_word_list()) IS NOT COPIED: text IS THE*/
+/*MEMORY MAPPING OF THE WHOLE FILE, AND mapped IS 1; ITS UNITS ARE LINES, */
+/*AND lines IS 1: THE NEWLINES AND CARRIAGE RETURNS UP TO THE NEXT UNIT   */
+/*ARE NOT PART OF A UNIT. WHEN mapped IS 2 ALL ARRAYS POINT INTO THE      */
+/*MAPPING OF A COMPILED GRAMMAR FILE, AND ARE FREED WITH THE IMAGE        */
 typedef struct LEX
 {
-	char *argz;
-	size_t argz_size;
-} lexicon_argz_structure;
+	char *text;
+	short int mapped;
+	size_t text_size;
+	size_t text_used;
+	size_t *unit_start;
+	short int lines;
+	unsigned int *unit_weight;
+	unsigned int *alias_threshold;
+	int *alias;
+	int unit_count;
+	int unit_size;
+} lexicon_structure;
 
 
 /*PARSE TREE STRUCTURE*/
@@ -152,42 +391,184 @@ typedef struct TREE_NODE{
 
 typedef struct PARSE_TREE{
 	tree_node *root;
+	/*ALL NODES AND CHILDREN ARRAYS OF THE TREE ARE BUMP-ALLOCATED HERE*/
+	arena *nodes;
 }parse_tree;
 
+/*GENERATOR CONTEXT: THE GRAMMAR, THE INPUT AND OUTPUT STREAMS AND THE   */
+/*OPTIONS OF A GENERATOR. CONTEXTS ARE INDEPENDENT, SO MANY GRAMMARS CAN  */
+/*BE KEPT IN ONE PROCESS; THEY ARE LOADED ONE AT A TIME, THOUGH, SINCE    */
+/*THE SCANNERS ARE NOT REENTRANT (SEE parsing_context IN context.c)       */
+typedef struct GEN_CONTEXT
+{
+	/*THE GRAMMAR AND IT'S STARTING SYMBOL*/
+	symbol_list_entry *symbol_table;
+	symbol_id starting_symbol;
+	/*INPUT FILES. THE LEXICON FILE IS OPTIONAL*/
+	char *input_grammar_file_path;
+	FILE *input_grammar_stream;
+	char *input_lexicon_file_path;
+	FILE *input_lexicon_stream;
+	short int input_lexicon_flag;
+	/*WORD LISTS, AS "TOKEN:FILE" ARGUMENTS OF THE -l OPTION (NOT COPIED)*/
+	char **word_list;
+	int word_list_count;
+	/*FILE WHERE THE COMPILED GRAMMAR IS SAVED (-C OPTION), NULL IF NONE*/
+	char *compiled_grammar_file_path;
+	/*SET WHEN THE GRAMMAR IS LOADED WITH LEXICONS (FROM ANY SOURCE)*/
+	short int lexicon_flag;
+	/*OUTPUT SINKS. THEY ARE NOT CLOSED BY clean_generator_context()*/
+	FILE *output_stream;
+	FILE *message_stream;
+	/*OPTIONS*/
+	int verbosity;
+	short int no_spaces_flag;
+	short int standard_output_flag;
+	tree_mode parse_tree_mode;
+	/*RANGE OF THE NUMBER OF TOKENS OF THE RANDOM SENTENCES (-L OPTION),*/
+	/*AND THE DERIVATION COUNTS USED TO GENERATE THEM. max IS -1 IF FREE */
+	int sentence_min_length;
+	int sentence_max_length;
+	length_table *lengths;
+	/*RANGE OF THE NUMBER OF TOKENS OF THE SENTENCES OF THE BOLTZMANN   */
+	/*SAMPLER (-b OPTION), AND IT'S PARAMETER. max IS -1 IF NOT IN USE  */
+	int boltzmann_min_size;
+	int boltzmann_max_size;
+	double boltzmann_parameter;
+	/*STATE OF THE COVERAGE GENERATION (-c OPTION), NULL IF NOT IN USE,*/
+	/*WHAT MUST BE COVERED (-k OPTION) AND THE FILE KEEPING WHAT IS    */
+	/*COVERED BETWEEN RUNS (-S OPTION, SEE state.c), NULL IF NONE      */
+	coverage_table *coverage;
+	coverage_criterion criterion;
+	char *coverage_state_file_path;
+	/*BASE SEED OF ALL RANDOM NUMBER GENERATORS*/
+	unsigned long seed;
+	/*WORKING VARIABLES OF THE GRAMMAR PARSER AND OF THE LEXICON SCANNER*/
+	rule_list_entry *r;
+	rule_list_entry *r_list;
+	rule_list_entry *r_last;
+	symbol_id current_symbol_for_lexicon;
+} generator_context;
+
+/*STATE OF A SENTENCE GENERATOR. GENERATORS IN DIFFERENT THREADS SHARE*/
+/*ONLY THE (READ-ONLY) COMPILED GRAMMAR, AND OWN EVERYTHING ELSE      */
+typedef struct GEN_STATE
+{
+	/*STATE OF THE PRIVATE RANDOM NUMBER GENERATOR*/
+	uint64_t rng;
+	/*STREAM RECEIVING THE TEXT OF THE SENTENCES, AND THE BUFFER IN FRONT*/
+	/*OF IT (SEE output.c)                                               */
+	FILE *output;
+	char *buffer;
+	size_t buffer_used;
+	size_t buffer_size;
+	/*SCRATCH SPACE REUSED ACROSS SENTENCES. pt IS NULL IF NO TREE IS BUILT*/
+	stack *st;
+	parse_tree *pt;
+	/*TERMINALS OF A SENTENCE WHICH MAY STILL BE REJECTED, SEE grow_boltzmann()*/
+	stack *terminals;
+} generation_state;
+
+/*---------------------------*/
+/*GLOBAL VARIABLE DECLARATION*/
+/*---------------------------*/
+
+/*MESSAGE STREAM AND VERBOSITY OF THE CONTEXT IN USE IN THE CURRENT THREAD*/
+/*(SEE use_generator_context())                                           */
+extern __thread FILE *message_stream;
+extern __thread int verbosity;
+/*CONTEXT OF THE GRAMMAR BEING LOADED, FOR THE SCANNERS AND THE PARSER*/
+extern generator_context *parsing_context;
+
 /*-------------------*/
 /*FUNCTION DEFINITION*/
 /*-------------------*/
 
 /*GENERATION FUNCTIONS*/
-rule_list_entry *get_random_rle(symbol_list_entry *sle);
+rule_list_entry *get_random_rle(generation_state *gs, symbol_list_entry *sle);
 rule_list_entry *get_terminal_rle(symbol_list_entry *sle);
-rule_list_entry *choose(symbol_list_entry *sle, symbol_list_entry *symbol_table);
-rule_list_entry *get_unvisited_rle(symbol_list_entry *sle);
-rule_list_entry *get_with_deep_unvisited_rle(symbol_list_entry *sle, symbol_list_entry *symbol_table);
+rule_list_entry *choose(coverage_table *ct, symbol_list_entry *sle, symbol_list_entry *symbol_table, int position);
 int rle_minimal_length(rule_list_entry *rle, symbol_list_entry *symbol_table);
 int symbol_minimal_length(symbol_list_entry *sle, symbol_list_entry *symbol_table);
 rule_list_entry *get_shortest_rle(symbol_list_entry *sle, symbol_list_entry *symbol_table);
-void push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_table, tree_node *tree);
+void push_rule_on_stack(stack *st, rule_list_entry *rle, symbol_list_entry *symbol_table, parse_tree *pt, tree_node *tree);
+tree_node *get_current_tree(tree_node *node);
 
-void generate_terminal_text(symbol_list_entry *s);
-void print_string(char *point);
+void generate_terminal_text(generation_state *gs, symbol_list_entry *s, symbol_list_entry *symbol_table);
+size_t decode_escapes(char *point, char *dest);
 char get_escaped_char(char c);
-void generate_blank_text();
-
-void grow_shortest(symbol_list_entry *rle, symbol_list_entry *symbol_table);
-void grow(symbol_id starting_symbol, symbol_list_entry *symbol_table);
-void purdom(symbol_id starting_symbol, symbol_list_entry *symbol_table);
+void generate_blank_text(generation_state *gs);
+
+void grow_shortest(generator_context *ctx, generation_state *gs, symbol_list_entry *sle);
+void grow(generator_context *ctx, generation_state *gs);
+void purdom(generator_context *ctx, generation_state *gs);
+
+/*COVERAGE GENERATION FUNCTIONS*/
+void build_coverage_table(generator_context *ctx);
+void clean_coverage_table(coverage_table *ct);
+void prepare_coverage_sentence(coverage_table *ct, symbol_list_entry *symbol_table);
+rule_list_entry *get_uncovered_pair_rle(coverage_table *ct, symbol_list_entry *symbol_table, int position);
+void cover_rule(coverage_table *ct, symbol_list_entry *symbol_table, rule_list_entry *rle, int position);
+int mark_covered(coverage_table *ct, grammar_image *image, int r, int position);
+void generate_coverage(generator_context *ctx, char *separator, int minimize, int jobs);
+
+/*COVERAGE STATE FUNCTIONS*/
+void load_coverage_state(generator_context *ctx, char *path);
+void save_coverage_state(generator_context *ctx, char *path);
+
+/*LENGTH-TARGETED GENERATION FUNCTIONS*/
+void build_length_table(generator_context *ctx);
+void clean_length_table(length_table *lt);
+void grow_length(generator_context *ctx, generation_state *gs);
+
+/*BOLTZMANN GENERATION FUNCTIONS*/
+void tune_boltzmann_sampler(generator_context *ctx);
+void grow_boltzmann(generator_context *ctx, generation_state *gs);
+
+/*BATCH GENERATION FUNCTIONS*/
+generation_state *initialize_new_generation_state(FILE *output, symbol_id starting_symbol, int with_tree);
+void clean_generation_state(generation_state *gs);
+
+/*OUTPUT FUNCTIONS*/
+void write_output(generation_state *gs, const char *bytes, size_t length);
+char *reserve_output(generation_state *gs, size_t length);
+void commit_output(generation_state *gs, size_t length);
+void flush_output(generation_state *gs);
+void generate_batch(generator_context *ctx, int repeat, int jobs, char *separator);
+
+/*GENERATOR CONTEXT FUNCTIONS*/
+generator_context *initialize_new_generator_context();
+void use_generator_context(generator_context *ctx);
+void load_grammar(generator_context *ctx);
+void clean_generator_context(generator_context *ctx);
+
+/*COMPILED GRAMMAR FILE FUNCTIONS*/
+int is_grammar_image_file(FILE *f);
+void save_grammar_image(generator_context *ctx, char *path);
+void load_grammar_image(generator_context *ctx);
 
 /*DATA STRUCTURE CONSTRUCTION FUNCTIONS*/
-void build_tables();
-void check_grammar(symbol_list_entry *sle, symbol_id starting_symbol);
-int check_error_only(symbol_list_entry *work_sle);
+void build_tables(generator_context *ctx);
+void check_grammar(generator_context *ctx);
+int check_error_only(symbol_list_entry *work_sle, symbol_id starting_symbol);
 void normalize_rules(symbol_list_entry *sle);
-int check_infinite_loops(symbol_list_entry *sle);
-void do_lexicon_scanning();
-void add_lexical_unit(symbol_id s_id);
+void compute_alias_table(double *weight, int n, unsigned int *threshold, int *alias);
+void build_alias_table(symbol_list_entry *sle);
+void build_lexicon_alias_table(lexicon_structure *lex);
+int check_infinite_loops(symbol_list_entry *work_sle);
+void do_lexicon_scanning(generator_context *ctx);
+unsigned long read_lexicon_weight();
+void load_word_list(generator_context *ctx, char *word_list);
+void add_lexical_unit(generator_context *ctx, symbol_id s_id);
 rule_type determine_rule_type(symbol_id self_id, rule_list_entry *rle, symbol_list_entry *symbol_table);
 void epure_symbol(symbol_list_entry *sle, symbol_list_entry *symbol_table);
+void compile_grammar(symbol_list_entry *symbol_table);
+void compute_minimal_lengths(symbol_list_entry *symbol_table);
+void min_length_queue_push(min_length_queue_entry *q, int *size, int length, int rule);
+min_length_queue_entry min_length_queue_pop(min_length_queue_entry *q, int *size);
+int min_length_add(int a, int b);
+void compile_terminal_text(symbol_list_entry *symbol_table);
+int get_rule_index(symbol_list_entry *symbol_table, rule_list_entry *rle);
 
 /*EXPLICIT DECLARATION OF SCANNER AND PARSER AUTOMATICALLY GENERATED FUNCTIONS*/
 int yylex();
@@ -202,6 +583,7 @@ symbol_id insert_symbol(symbol_list_entry *l, char* new_name, symbol_type t);
 void remove_sle(symbol_list_entry *symbol_table, symbol_id id);
 symbol_list_entry *get_symbol(symbol_list_entry *l, symbol_id id);
 symbol_list_entry *get_symbol_by_name(symbol_list_entry *l, char *name);
+symbol_list_entry *get_symbol_by_name_and_kind(symbol_list_entry *l, char *name, int literal);
 void locate_symbol_in_sle(symbol_id id, symbol_list_entry *sle, int *loc);
 void visit_symbol_list(	symbol_list_entry *l, symbol_list_entry *symbol_table, int visited_value);
 
@@ -221,14 +603,18 @@ int is_ONLY_TERMINALS(rule_list_entry *r);
 /*RLE LIST RELATED FUNCTIONS*/
 void insert_rle(symbol_list_entry *l, rule_list_entry *new_rule);
 void remove_rle(symbol_list_entry *l, int pos);
+void remove_next_rle(symbol_list_entry *l, rule_list_entry *prev);
 rule_list_entry *get_rle(symbol_list_entry *l, int pos);
-rule_list_entry *link_rle(rule_list_entry *l, rule_list_entry *new_rle);
+rule_list_entry *link_rle(rule_list_entry *l, rule_list_entry *last, rule_list_entry *new_rle);
+void insert_rle_list(symbol_list_entry *l, rule_list_entry *list);
 
 /*RLE RELATED FUNCTIONS*/
 void insert_symbol_rle(rule_list_entry *r, symbol_id sym);
 int remove_symbol_rle(rule_list_entry *r, int pos);
 symbol_id extract_symbol_rle(rule_list_entry *r, int pos);
 void modify_symbol_rle(rule_list_entry *rle, int pos, symbol_id new_value);
+unsigned long hash_rle(rule_list_entry *r);
+int equal_rle(rule_list_entry *a, rule_list_entry *b);
 rule_list_entry *initialize_new_rle();
 
 /*RULE RELATED FUNCTIONS*/
@@ -243,20 +629,38 @@ stack *initialize_new_stack();
 symbol_id pop(stack *st);
 int push(stack *st, symbol_id symb);
 int get_size(stack *st);
+void reset_stack(stack *st);
 int clean_stack(stack *st);
 
 /*LEXICON ARGZ STRUCTURE RELATED FUNCTIONS*/
-lexicon_argz_structure *initialize_new_lexicon_argz_structure();
+lexicon_structure *initialize_new_lexicon_structure();
+void insert_lexicon_unit(lexicon_structure *lex, char *unit);
+char *get_lexicon_unit(lexicon_structure *lex, int pos, size_t *length);
+void set_lexicon_unit_weight(lexicon_structure *lex, int pos, unsigned int weight);
+void clean_lexicon_structure(lexicon_structure *lex);
+
+/*ARENA RELATED FUNCTIONS*/
+arena *initialize_new_arena(size_t chunk_size);
+void *arena_alloc(arena *a, size_t size);
+char *arena_strdup(arena *a, char *s);
+void reset_arena(arena *a);
+void clean_arena(arena *a);
 
 /*MESSAGE PRINTING FUNCTIONS*/
-void print_symbol_list(symbol_list_entry *l);
-void print_rule_list(symbol_list_entry *l);
+void print_symbol_list(symbol_list_entry *l, symbol_id starting_symbol);
+void print_rule_list(symbol_list_entry *l, symbol_list_entry *symbol_table);
 void print_lexicon_table(symbol_list_entry *l);
+void print_escaped_bytes(FILE *f, char *bytes, size_t length);
 int must_print_message(source_type class);
 
 /*UTILITY FUNCTIONS*/
-void set_random_seed();
+unsigned long set_random_seed(long seed);
+void seed_generation_state(generation_state *gs, unsigned long seed, unsigned long sequence);
+long generation_random(generation_state *gs);
 int read_number(char *string);
+tree_mode read_tree_mode(char *string);
+coverage_criterion read_coverage_criterion(char *string);
+void read_length_range(char *string, int *min, int *max);
 FILE *open_file_read(char *string);
 FILE *open_file_write(char *string);
 void *xmalloc(size_t size);
@@ -268,13 +672,16 @@ void print_usage();
 void clean_symbol_list(symbol_list_entry *l);
 void clean_rle_list(rule_list_entry *l);
 void clean_rule(rule_t *r);
+void clean_grammar_image(grammar_image *image);
 void clean_up(void);
 
 /*PARSE TREE FUNCTIONS*/
-tree_node *init_tree_node(symbol_id sym);
-tree_node *init_empty_tree_node(void);
-int tree_node_push_child(tree_node *node, symbol_id sym);
-//void tree_node_clean(tree_node *node);
+tree_node *init_tree_node(arena *a, symbol_id sym);
+tree_node *init_empty_tree_node(arena *a);
+int tree_node_push_child(parse_tree *tree, tree_node *node, symbol_id sym);
+void tree_node_reserve_children(parse_tree *tree, tree_node *node, int n);
 parse_tree * init_parse_tree(symbol_id sym);
+void parse_tree_reset(parse_tree *tree, symbol_id sym);
 void parse_tree_clean(parse_tree *tree);
-void print_tree(tree_node *root, symbol_list_entry* sym_tab);
+void print_tree(FILE *f, tree_node *root, symbol_list_entry* sym_tab);
+void print_tree_compact(FILE *f, tree_node *root, symbol_list_entry* sym_tab);
@@ -0,0 +1,436 @@
+/*
+length.c -- counting of derivations and generation of sentences of a given length
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <math.h>
+
+/*SENTENCES OF A GIVEN NUMBER OF TOKENS ARE GENERATED UNIFORMLY AMONG ALL*/
+/*THE PARSE TREES OF THAT SIZE: EVERY RULE, AND THE NUMBER OF TOKENS OF  */
+/*EVERY SYMBOL OF THE RULE, ARE CHOSEN WITH A PROBABILITY PROPORTIONAL TO*/
+/*THE NUMBER OF DERIVATIONS THEY LEAVE. EVERY TERMINAL IS ONE TOKEN.     */
+/*COUNTS ARE KEPT AS double: THEY ARE EXACT UP TO 2^53, AND APPROXIMATED */
+/*(WITH A NEGLIGIBLE BIAS) BEYOND. THEY GROW EXPONENTIALLY WITH THE      */
+/*NUMBER OF TOKENS, SO THE COUNTS OF n TOKENS ARE KEPT MULTIPLIED BY C^n:*/
+/*THE PRODUCTS OF THE COUNTS OF l AND n - l TOKENS ARE MULTIPLIED BY C^n */
+/*TOO, AND THE CHOICES ONLY COMPARE COUNTS OF THE SAME LENGTH. C STARTS  */
+/*AT 1, AND IS LOWERED WHEN THE COUNTS GET OVER LENGTH_COUNT_LIMIT       */
+
+#define LENGTH_COUNT_LIMIT 1e100
+
+/*THE STACK OF grow_length() HOLDS A SYMBOL AND IT'S NUMBER OF TOKENS*/
+#define PACK_SYMBOL(s, n) ((((symbol_id)(n)) << 32) | (s))
+#define PACKED_SYMBOL(p) ((p) & 0xFFFFFFFFUL)
+#define PACKED_LENGTH(p) ((int)((p) >> 32))
+
+
+/*RETURNS THE FIRST ROW OF THE SUFFIX COUNTS OF RULE rle*/
+static int
+suffix_base(grammar_image *image, rule_list_entry *rle)
+{
+	return (int)(rle->rhs - image->rhs) + (int)(rle - image->rules);
+}
+
+
+/*RETURNS A PSEUDO-RANDOM NUMBER IN [0, 1) FROM THE GENERATOR OF gs*/
+static double
+random_unit(generation_state *gs)
+{
+	double high = (double) generation_random(gs);
+	double low = (double) generation_random(gs);
+
+	return (high * 2147483648.0 + low) / 4611686018427387904.0;
+}
+
+
+/*COMPUTES THE DERIVATION COUNTS OF THE GRAMMAR OF ctx FOR SENTENCES OF UP*/
+/*TO sentence_max_length TOKENS. THE COUNTS OF n TOKENS ONLY DEPEND ON    */
+/*SHORTER ONES, EXCEPT THROUGH COPY RULES AND SYMBOLS DERIVING THE EMPTY  */
+/*STRING: FOR EVERY n, THAT PART IS ITERATED UNTIL IT DOES NOT CHANGE     */
+/*DOES NOT RETURN IF THERE ARE INFINITELY MANY DERIVATIONS OF SOME LENGTH,*/
+/*OR NO SENTENCE IN THE REQUIRED RANGE                                    */
+void
+build_length_table(generator_context *ctx)
+{
+	int i, n, symbols, stride, rows, nt_count = 0;
+	double *partial = NULL, log_scale = 0.0, total;
+	length_table *lt = NULL;
+	grammar_image *image = NULL;
+	symbol_list_entry *work_sle = NULL;
+
+	assert(ctx != NULL);
+	assert(ctx->lengths == NULL);
+	assert(ctx->sentence_max_length >= 0);
+	assert(ctx->sentence_min_length <= ctx->sentence_max_length);
+	work_sle = ctx->symbol_table;
+	assert(work_sle != NULL);
+	image = work_sle->index->image;
+	assert(image != NULL);
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "counting derivations of up to %d tokens...\n", ctx->sentence_max_length);
+
+	symbols = work_sle->rulecount;
+	stride = ctx->sentence_max_length + 1;
+	rows = image->rhs_size + image->rule_count + 1;
+
+	lt = xcalloc(1, sizeof(length_table));
+	lt->max_length = ctx->sentence_max_length;
+	lt->min_length = ctx->sentence_min_length;
+	lt->stride = stride;
+	lt->count = xcalloc((size_t)(symbols + 1) * stride, sizeof(double));
+	lt->suffix = xcalloc((size_t) rows * stride, sizeof(double));
+	lt->total = xcalloc(lt->max_length - lt->min_length + 1, sizeof(double));
+	partial = xcalloc(rows, sizeof(double));
+
+	for(i = 1; i <= symbols; i++)
+	{
+		symbol_list_entry *sle = get_symbol(work_sle, i);
+
+		if(is_NT(sle))
+			nt_count++;
+		/*A TERMINAL IS ONE TOKEN*/
+		else if(stride > 1)
+			lt->count[i * stride + 1] = 1.0;
+	}
+
+	for(n = 0; n <= lt->max_length; n++)
+	{
+		int pass;
+
+		/*THE PART OF THE SUFFIX COUNTS WHICH ONLY DEPENDS ON SHORTER LENGTHS*/
+		for(i = 0; i < image->rule_count; i++)
+		{
+			rule_list_entry *rle = &(image->rules[i]);
+			int base = suffix_base(image, rle);
+			int j;
+
+			lt->suffix[(base + rle->length) * stride + n] = (n == 0)? 1.0 : 0.0;
+			for(j = rle->length - 1; j >= 0; j--)
+			{
+				symbol_id x = rle->rhs[j];
+				double *next = &(lt->suffix[(base + j + 1) * stride]);
+				double sum = 0.0;
+
+				if(is_NT(get_symbol(work_sle, x)) == 0)
+				{
+					sum = (n >= 1)? lt->count[x * stride + 1] * next[n - 1] : 0.0;
+				}
+				else
+				{
+					double *cx = &(lt->count[x * stride]);
+					int l = (image->min_length[x] > 1)? image->min_length[x] : 1;
+
+					for(; l < n; l++)
+					{
+						sum += cx[l] * next[n - l];
+					}
+				}
+				partial[base + j] = sum;
+			}
+		}
+
+		/*THE REST, TO A FIXED POINT*/
+		for(pass = 0; ; pass++)
+		{
+			int changed = 0;
+
+			for(i = 0; i < image->rule_count; i++)
+			{
+				rule_list_entry *rle = &(image->rules[i]);
+				int base = suffix_base(image, rle);
+				int j;
+
+				for(j = rle->length - 1; j >= 0; j--)
+				{
+					symbol_id x = rle->rhs[j];
+					double *next = &(lt->suffix[(base + j + 1) * stride]);
+					double value = partial[base + j];
+
+					if(is_NT(get_symbol(work_sle, x)))
+					{
+						double *cx = &(lt->count[x * stride]);
+
+						value += cx[n] * next[0];
+						if(n > 0)
+							value += cx[0] * next[n];
+					}
+					lt->suffix[(base + j) * stride + n] = value;
+				}
+			}
+
+			for(i = 1; i <= symbols; i++)
+			{
+				symbol_list_entry *sle = get_symbol(work_sle, i);
+				rule_list_entry *rle = NULL;
+				double count = 0.0;
+
+				if(is_NT(sle) == 0)
+					continue;
+
+				for(rle = sle->rules; rle != NULL; rle = rle->next)
+				{
+					count += lt->suffix[suffix_base(image, rle) * stride + n];
+				}
+				if(isfinite(count) == 0)
+					error(BAD_ARGUMENTS, 0, "too many derivations of %d tokens to be counted", n);
+				if(count != lt->count[i * stride + n])
+				{
+					lt->count[i * stride + n] = count;
+					changed = 1;
+				}
+			}
+
+			if(changed == 0)
+				break;
+			/*WITHOUT CYCLES, EVERY PASS FIXES AT LEAST ONE MORE SYMBOL*/
+			if(pass > nt_count)
+				error(BAD_INPUT, 0, "infinitely many derivations of %d tokens, through cycles of copy or empty rules", n);
+		}
+
+		/*LOWER C SO THAT THE LARGEST COUNT OF n TOKENS BECOMES 1*/
+		if(n > 0)
+		{
+			double largest = 0.0, factor, f;
+			int k;
+
+			for(i = 1; i <= symbols; i++)
+			{
+				if(lt->count[i * stride + n] > largest)
+					largest = lt->count[i * stride + n];
+			}
+			for(i = 0; i < rows; i++)
+			{
+				if(lt->suffix[i * stride + n] > largest)
+					largest = lt->suffix[i * stride + n];
+			}
+			if(largest > LENGTH_COUNT_LIMIT)
+			{
+				f = pow(largest, -1.0 / n);
+				log_scale += log(f);
+				for(k = 1, factor = f; k <= n; k++, factor *= f)
+				{
+					for(i = 1; i <= symbols; i++)
+					{
+						lt->count[i * stride + k] *= factor;
+					}
+					for(i = 0; i < rows; i++)
+					{
+						lt->suffix[i * stride + k] *= factor;
+					}
+				}
+			}
+		}
+	}
+	free(partial);
+
+	/*THE SENTENCES OF n TOKENS ARE count / C^n, OR count * C^(max_length - n)*/
+	/*OVER C^max_length, WHICH IS THE SAME FOR ALL LENGTHS                    */
+	for(n = lt->min_length, total = 0.0; n <= lt->max_length; n++)
+	{
+		total += lt->count[ctx->starting_symbol * stride + n] * exp((lt->max_length - n) * log_scale);
+		lt->total[n - lt->min_length] = total;
+	}
+
+	if(lt->total[lt->max_length - lt->min_length] == 0.0)
+	{
+		if(lt->min_length == lt->max_length)
+			error(BAD_ARGUMENTS, 0, "the grammar has no sentence of %d tokens", lt->max_length);
+		else
+			error(BAD_ARGUMENTS, 0, "the grammar has no sentence of %d to %d tokens", lt->min_length, lt->max_length);
+	}
+
+	ctx->lengths = lt;
+
+	if(must_print_message(MAIN))
+	{
+		double digits = log10(total) - lt->max_length * log_scale / log(10.0);
+
+		if(digits < 15.0)
+			fprintf(message_stream, "...done: %g derivations of %d to %d tokens\n", pow(10.0, digits), lt->min_length, lt->max_length);
+		else
+			fprintf(message_stream, "...done: %.6ge+%d derivations of %d to %d tokens\n", pow(10.0, digits - floor(digits)), (int) floor(digits), lt->min_length, lt->max_length);
+	}
+}
+
+
+/*FREES THE DERIVATION COUNTS lt*/
+void
+clean_length_table(length_table *lt)
+{
+	assert(lt != NULL);
+
+	free(lt->count);
+	free(lt->suffix);
+	free(lt->total);
+	free(lt);
+}
+
+
+/*GENERATES A SENTENCE OF THE GRAMMAR OF ctx, WITH A NUMBER OF TOKENS IN*/
+/*THE RANGE OF ctx, UNIFORMLY AMONG ALL PARSE TREES OF THAT RANGE. gs IS */
+/*USED AS IN grow(), AND THE GRAMMAR IS NOT MODIFIED                     */
+void
+grow_length(generator_context *ctx, generation_state *gs)
+{
+	symbol_list_entry *symbol_table = ctx->symbol_table;
+	grammar_image *image = symbol_table->index->image;
+	length_table *lt = ctx->lengths;
+	int stride, n, span;
+	double u;
+	stack *st;
+	parse_tree *work_tree;
+	tree_node *current_tree = NULL;
+	symbol_id current = (symbol_id) 0;
+
+	assert(lt != NULL);
+	assert(gs != NULL);
+	assert(ctx->starting_symbol != (symbol_id) 0);
+
+	if(must_print_message(GENERATION))
+	{
+		fprintf(message_stream, "called grow_length for starting symbol\n");
+	}
+
+	stride = lt->stride;
+
+	/*PICK THE LENGTH OF THE SENTENCE: total IS CUMULATIVE*/
+	span = lt->max_length - lt->min_length;
+	u = random_unit(gs) * lt->total[span];
+	for(n = 0; n < span && u >= lt->total[n]; n++)
+		;
+	n += lt->min_length;
+	/*ROUNDING MAY LEAVE u ON A LENGTH WITHOUT SENTENCES, PAST THE LAST ONE*/
+	while(lt->count[ctx->starting_symbol * stride + n] == 0.0)
+		n--;
+	assert(n >= lt->min_length);
+
+	st = gs->st;
+	work_tree = gs->pt;
+	reset_stack(st);
+	if(work_tree != NULL)
+	{
+		parse_tree_reset(work_tree, ctx->starting_symbol);
+		current_tree = work_tree->root;
+		current_tree->expanded = 1;
+	}
+
+	push(st, PACK_SYMBOL(ctx->starting_symbol, n));
+	current = pop(st);
+
+	while(current != 0)
+	{
+		symbol_id s = PACKED_SYMBOL(current);
+		symbol_list_entry *sle = NULL;
+
+		n = PACKED_LENGTH(current);
+		sle = get_symbol(symbol_table, s);
+		assert(sle != NULL);
+
+		if(must_print_message(GENERATION))
+		{
+			fprintf(message_stream, "Stack size: %d, element popped: %d (%d tokens)\n", get_size(st), (int) s, n);
+		}
+
+		if(is_NT(sle) == 1)
+		{
+			rule_list_entry *rle = NULL, *chosen = NULL;
+			int base, j, m = n;
+
+			/*PICK THE RULE*/
+			u = random_unit(gs) * lt->count[s * stride + n];
+			for(rle = sle->rules; rle != NULL; rle = rle->next)
+			{
+				double c = lt->suffix[suffix_base(image, rle) * stride + n];
+
+				if(c > 0.0)
+				{
+					chosen = rle;
+					if(u < c)
+						break;
+					u -= c;
+				}
+			}
+			assert(chosen != NULL);
+			base = suffix_base(image, chosen);
+
+			/*PICK THE NUMBER OF TOKENS OF EVERY SYMBOL OF THE RULE*/
+			{
+				int lengths[chosen->length + 1];
+
+				for(j = 0; j < chosen->length; j++)
+				{
+					symbol_id x = chosen->rhs[j];
+					double *next = &(lt->suffix[(base + j + 1) * stride]);
+					double *cx = &(lt->count[x * stride]);
+					int l, picked = -1;
+
+					u = random_unit(gs) * lt->suffix[(base + j) * stride + m];
+					for(l = 0; l <= m; l++)
+					{
+						double c = cx[l] * next[m - l];
+
+						if(c > 0.0)
+						{
+							picked = l;
+							if(u < c)
+								break;
+							u -= c;
+						}
+					}
+					assert(picked >= 0);
+					lengths[j] = picked;
+					m -= picked;
+				}
+				assert(m == 0);
+
+				for(j = chosen->length - 1; j >= 0; j--)
+				{
+					push(st, PACK_SYMBOL(chosen->rhs[j], lengths[j]));
+				}
+			}
+
+			if(current_tree != NULL)
+			{
+				tree_node_reserve_children(work_tree, current_tree, chosen->length);
+				for(j = 0; j < chosen->length; j++)
+				{
+					tree_node_push_child(work_tree, current_tree, chosen->rhs[j]);
+				}
+			}
+		}
+		else
+		{
+			assert(n == 1);
+			generate_terminal_text(gs, sle, symbol_table);
+
+			if(ctx->no_spaces_flag == 0)
+				generate_blank_text(gs);
+		}
+
+		current = pop(st);
+		/*KEEP current_tree ON THE NODE OF THE SYMBOL JUST POPPED*/
+		if(current_tree != NULL && current != 0)
+		{
+			current_tree = get_current_tree(current_tree);
+			assert(current_tree != NULL);
+			assert(current_tree->sym == PACKED_SYMBOL(current));
+		}
+	}
+}
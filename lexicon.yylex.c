@@ -775,15 +775,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define remove_quotes(M) M+=sizeof(char);M[yy_lexiconleng-2]='\0'; yy_lexiconleng-=2
 
 
-/*GLOBALS DEFINED IN CALLING FUNCTION*/
-extern char *input_lexicon_file_path;
-extern symbol_id current_symbol_for_lexicon;
-extern FILE *message_stream;
-extern symbol_list_entry *symbol_table;
+/*FIELDS OF THE CONTEXT WHOSE LEXICON IS BEING LOADED (SET BY build_tables())*/
+#define input_lexicon_file_path (parsing_context->input_lexicon_file_path)
+#define current_symbol_for_lexicon (parsing_context->current_symbol_for_lexicon)
+#define symbol_table (parsing_context->symbol_table)
 
-#line 784 "lexicon.yylex.c"
+#line 783 "lexicon.yylex.c"
 
-#line 786 "lexicon.yylex.c"
+#line 785 "lexicon.yylex.c"
 
 #define INITIAL 0
 #define in_association 1
@@ -1001,10 +1000,10 @@ YY_DECL
 		}
 
 	{
-#line 50 "lexicon.lex"
+#line 49 "lexicon.lex"
 
 
-#line 1007 "lexicon.yylex.c"
+#line 1006 "lexicon.yylex.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -1073,14 +1072,14 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 52 "lexicon.lex"
+#line 51 "lexicon.lex"
 {
 				symbol_list_entry *sle = NULL;
 
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITH("found IDENTIFIER, searching in symbol table");
 				
-				sle = get_symbol_by_name(symbol_table, yy_lexicontext);
+				sle = get_symbol_by_name_and_kind(symbol_table, yy_lexicontext, 0);
 
 				if(sle == NULL)
 				{
@@ -1106,7 +1105,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 82 "lexicon.lex"
+#line 81 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITH("found IDENTIFIER, expecting LEXICAL UNIT or SEMICOLON");
@@ -1115,7 +1114,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 88 "lexicon.lex"
+#line 87 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITHOUT("found SEMICOLON, expected IDENTIFIER");
@@ -1124,7 +1123,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 94 "lexicon.lex"
+#line 93 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITHOUT("found SEMICOLON, waiting for new IDENTIFIER");
@@ -1133,7 +1132,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 100 "lexicon.lex"
+#line 99 "lexicon.lex"
 {
 				remove_quotes(yy_lexicontext);
 				if(must_print_message(L_SCANNER))
@@ -1143,7 +1142,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 107 "lexicon.lex"
+#line 106 "lexicon.lex"
 {
 				remove_quotes(yy_lexicontext);
 				if(must_print_message(L_SCANNER))
@@ -1153,7 +1152,7 @@ YY_RULE_SETUP
 			}
 	YY_BREAK
 case YY_STATE_EOF(in_association):
-#line 115 "lexicon.lex"
+#line 114 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITHOUT("found END OF FILE, expecting SEMICOLON");
@@ -1161,7 +1160,7 @@ case YY_STATE_EOF(in_association):
 			}
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
-#line 121 "lexicon.lex"
+#line 120 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITHOUT("reached end of file, no errors");
@@ -1170,7 +1169,7 @@ case YY_STATE_EOF(INITIAL):
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 127 "lexicon.lex"
+#line 126 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITHOUT("found empty string literal");
@@ -1180,14 +1179,14 @@ YY_RULE_SETUP
 case 8:
 /* rule 8 can match eol */
 YY_RULE_SETUP
-#line 133 "lexicon.lex"
+#line 132 "lexicon.lex"
 {
 				/*EAT WHITESPACE*/
 			}
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 137 "lexicon.lex"
+#line 136 "lexicon.lex"
 {
 				if(must_print_message(L_SCANNER))
 					MESSAGE_WITH("found unexpected character");
@@ -1196,10 +1195,10 @@ YY_RULE_SETUP
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 143 "lexicon.lex"
+#line 142 "lexicon.lex"
 ECHO;
 	YY_BREAK
-#line 1202 "lexicon.yylex.c"
+#line 1201 "lexicon.yylex.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -2214,6 +2213,44 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 143 "lexicon.lex"
+#line 142 "lexicon.lex"
 
+/*READS THE OPTIONAL WEIGHT OF THE LEXICAL UNIT JUST SCANNED, WRITTEN AS */
+/*":n" RIGHT AFTER IT'S CLOSING QUOTE. CALLED BETWEEN TWO yy_lexiconlex()*/
+/*CALLS; RETURNS 1 IF THERE IS NO WEIGHT, 0 IF IT IS MALFORMED OR LARGER */
+/*THAN MAX_LEXICON_WEIGHT                                                */
+unsigned long
+read_lexicon_weight()
+{
+	int c;
+	unsigned long weight = 0;
+
+	c = input();
+	if(c != ':')
+	{
+		if(c > 0)
+			unput(c);
+		return 1;
+	}
+
+	c = input();
+	if(!isdigit(c))
+	{
+		if(c > 0)
+			unput(c);
+		return 0;
+	}
+
+	while(isdigit(c))
+	{
+		weight = weight * 10 + (c - '0');
+		if(weight > MAX_LEXICON_WEIGHT)
+			weight = MAX_LEXICON_WEIGHT + 1;
+		c = input();
+	}
+	if(c > 0)
+		unput(c);
+
+	return (weight > MAX_LEXICON_WEIGHT)? 0 : weight;
+}
 
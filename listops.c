@@ -23,7 +23,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 extern int rc_values[];
 extern char *symbol_type_names[];
-extern FILE *message_stream;
+
+/*MARKS SLOTS OF THE NAME HASH TABLE FREED BY remove_sle*/
+static symbol_list_entry hash_tombstone;
+
+static unsigned long hash_name(char *name);
+static void hash_symbol(symbol_index *idx, symbol_list_entry *sle);
+static void unhash_symbol(symbol_index *idx, symbol_list_entry *sle);
+static symbol_list_entry *lookup_name(symbol_index *idx, char *name, int literal);
 
 /*******************************/
 /*SYMBOL LIST RELATED FUNCTIONS*/
@@ -41,8 +48,20 @@ initialize_new_symbol_list()
 	/*IN HEAD NODE 'rules' IS USED AS TAIL POINTER;*/
 	/*         'rulecount' IS USED AS NODE COUNTER;*/
 	s->rules = (rule_list_entry *) s;		// let it point to itself
-	s->name = xmalloc(strlen(str));
-	strcpy(s->name, str);
+
+	/*THE HEAD NODE ALSO OWNS THE DENSE INDEX USED BY get_symbol,     */
+	/*THE NAME HASH TABLE AND THE ARENA WHERE ALL NAMES ARE INTERNED  */
+	s->index = xmalloc(sizeof(symbol_index));
+	s->index->symbols = xcalloc(SYMBOL_INDEX_DEFAULT_SIZE, sizeof(symbol_list_entry *));
+	s->index->size = SYMBOL_INDEX_DEFAULT_SIZE;
+	s->index->symbols[0] = s;
+	s->index->hash = xcalloc(SYMBOL_HASH_DEFAULT_SIZE, sizeof(symbol_hash_slot));
+	s->index->hash_size = SYMBOL_HASH_DEFAULT_SIZE;
+	s->index->hash_used = 0;
+	s->index->names = initialize_new_arena(NAME_ARENA_CHUNK_SIZE);
+	s->index->image = NULL;
+
+	s->name = arena_strdup(s->index->names, str);
 	
 	return s;
 }
@@ -75,8 +94,29 @@ insert_symbol(symbol_list_entry *l, char *new_name, symbol_type t)
 	sle = sle->next;
 
 	sle->id = new_id;
-	sle->name = xmalloc(strlen(new_name) + sizeof(char));
-	strcpy(sle->name, new_name);
+
+	/*NAMES ARE INTERNED: A LITERAL AND AN IDENTIFIER WITH THE SAME TEXT*/
+	/*SHARE THE SAME COPY IN THE NAME ARENA                             */
+	{
+		symbol_list_entry *same_name = NULL;
+
+		same_name = lookup_name(l->index, new_name, -1);
+		if(same_name != NULL)
+			sle->name = same_name->name;
+		else
+			sle->name = arena_strdup(l->index->names, new_name);
+	}
+
+	/*KEEP THE DENSE INDEX IN SYNC, DOUBLING IT WHEN FULL*/
+	if(new_id >= (symbol_id) l->index->size)
+	{
+		l->index->symbols = realloc(l->index->symbols, 2 * l->index->size * sizeof(symbol_list_entry *));
+		if(l->index->symbols == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+		l->index->size *= 2;
+	}
+	l->index->symbols[new_id] = sle;
+	hash_symbol(l->index, sle);
 	
 	switch(t)
 	{
@@ -112,7 +152,7 @@ remove_sle(symbol_list_entry *symbol_table, symbol_id id)
 	
 	assert(id != (symbol_id) 0);
 	assert(symbol_table != NULL);
-	assert(id <= symbol_table->rulecount);
+	assert(id <= (symbol_id) symbol_table->rulecount);
 	
 	if(id != 1)
 	{
@@ -131,19 +171,22 @@ remove_sle(symbol_list_entry *symbol_table, symbol_id id)
 
 	*pointer_s_to_rem = s_to_rem->next;
 	
-	free(s_to_rem->name);
+	/*THE NAME LIVES IN THE ARENA AND IS RELEASED WITH THE WHOLE TABLE*/
+	unhash_symbol(symbol_table->index, s_to_rem);
 	free(s_to_rem);
 
-	/*UPDATE IDs*/
+	/*UPDATE IDs AND SHIFT THE DENSE INDEX DOWN BY ONE SLOT*/
 	for(i=id+1; i <= symbol_table->rulecount; i++)
 	{
 		symbol_list_entry *sle = NULL;
 
-		sle = get_symbol(symbol_table, i);
+		sle = symbol_table->index->symbols[i];
 		assert(sle != NULL);
 
 		sle->id--;
+		symbol_table->index->symbols[i-1] = sle;
 	}
+	symbol_table->index->symbols[symbol_table->rulecount] = NULL;
 	symbol_table->rulecount--;
 
 	/*UPDATE RULES*/
@@ -197,6 +240,14 @@ get_symbol(symbol_list_entry *l, symbol_id id)
 	
 	if(must_print_message(LISTOPS))
 		fprintf(message_stream, "getting symbol at id: %d\n", id);
+
+	/*THE HEAD NODE CARRIES A DENSE INDEX: A SINGLE LOOKUP IS ENOUGH*/
+	if(l->index != NULL)
+	{
+		if(id > (symbol_id) l->rulecount)
+			return NULL;
+		return l->index->symbols[id];
+	}
 	
 	while(l != NULL)
 	{
@@ -219,6 +270,10 @@ get_symbol_by_name(symbol_list_entry *l, char *name)
 	if(must_print_message(LISTOPS))
 		fprintf(message_stream, "getting symbol with name %s\n", name);
 
+	/*THE HEAD NODE CARRIES A NAME HASH TABLE: NO NEED TO WALK THE LIST*/
+	if(l->index != NULL)
+		return lookup_name(l->index, name, -1);
+
 	if(l->id == 0 && l->next == NULL)
 		return NULL;
 	if(l->id == 0) 
@@ -233,6 +288,129 @@ get_symbol_by_name(symbol_list_entry *l, char *name)
 	return NULL;
 }
 
+/*SEARCH FOR SYMBOL name IN LIST l, CONSIDERING ONLY LITERALS (literal == 1) */
+/*OR ONLY IDENTIFIERS (literal == 0). RETURNS POINTER OR NULL ON FAILURE     */
+/*A LITERAL AND AN IDENTIFIER CAN SHARE THE SAME NAME, SCANNERS MUST USE THIS*/
+symbol_list_entry *
+get_symbol_by_name_and_kind(symbol_list_entry *l, char *name, int literal)
+{
+	assert(l != NULL);
+	assert(l->index != NULL);
+	assert(name != NULL);
+	assert(literal == 0 || literal == 1);
+
+	if(must_print_message(LISTOPS))
+		fprintf(message_stream, "getting %s with name %s\n", (literal)? "literal":"identifier", name);
+
+	return lookup_name(l->index, name, literal);
+}
+
+/*FNV-1a HASH OF A NULL TERMINATED STRING*/
+static unsigned long
+hash_name(char *name)
+{
+	unsigned long h = 2166136261UL;
+
+	while(*name != '\0')
+	{
+		h ^= (unsigned char) *name++;
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+/*INSERTS sle IN THE NAME HASH TABLE OF idx (LINEAR PROBING)      */
+/*THE TABLE IS DOUBLED WHEN IT WOULD BECOME MORE THAN HALF FULL   */
+static void
+hash_symbol(symbol_index *idx, symbol_list_entry *sle)
+{
+	unsigned long h;
+	int i;
+
+	assert(idx != NULL);
+	assert(sle != NULL);
+
+	if(2 * (idx->hash_used + 1) > idx->hash_size)
+	{
+		symbol_hash_slot *old = idx->hash;
+		int old_size = idx->hash_size;
+
+		idx->hash_size *= 2;
+		idx->hash = xcalloc(idx->hash_size, sizeof(symbol_hash_slot));
+		idx->hash_used = 0;
+
+		for(i = 0; i < old_size; i++)
+		{
+			if(old[i].sle != NULL && old[i].sle != &hash_tombstone)
+				hash_symbol(idx, old[i].sle);
+		}
+		free(old);
+	}
+
+	h = hash_name(sle->name);
+	i = (int)(h & (unsigned long)(idx->hash_size - 1));
+	while(idx->hash[i].sle != NULL)
+		i = (i + 1) & (idx->hash_size - 1);
+
+	idx->hash[i].hash = h;
+	idx->hash[i].sle = sle;
+	idx->hash_used++;
+}
+
+/*REPLACES THE SLOT HOLDING sle WITH A TOMBSTONE*/
+static void
+unhash_symbol(symbol_index *idx, symbol_list_entry *sle)
+{
+	unsigned long h;
+	int i;
+
+	assert(idx != NULL);
+	assert(sle != NULL);
+
+	h = hash_name(sle->name);
+	i = (int)(h & (unsigned long)(idx->hash_size - 1));
+	while(idx->hash[i].sle != NULL)
+	{
+		if(idx->hash[i].sle == sle)
+		{
+			idx->hash[i].sle = &hash_tombstone;
+			return;
+		}
+		i = (i + 1) & (idx->hash_size - 1);
+	}
+	/*THE SYMBOL MUST HAVE BEEN HASHED BY insert_symbol*/
+	assert(0);
+}
+
+/*RETURNS THE SYMBOL WITH THE LOWEST ID CALLED name. A NEGATIVE literal  */
+/*MATCHES ANY SYMBOL, OTHERWISE is_LITERAL() MUST BE EQUAL TO literal    */
+static symbol_list_entry *
+lookup_name(symbol_index *idx, char *name, int literal)
+{
+	symbol_list_entry *found = NULL;
+	unsigned long h;
+	int i;
+
+	h = hash_name(name);
+	i = (int)(h & (unsigned long)(idx->hash_size - 1));
+	while(idx->hash[i].sle != NULL)
+	{
+		symbol_list_entry *sle = idx->hash[i].sle;
+
+		if(sle != &hash_tombstone && idx->hash[i].hash == h
+			&& strcmp(name, sle->name) == 0
+			&& (literal < 0 || is_LITERAL(sle) == literal)
+			&& (found == NULL || sle->id < found->id))
+		{
+			found = sle;
+		}
+		i = (i + 1) & (idx->hash_size - 1);
+	}
+
+	return found;
+}
+
 /*LOCATES THE FIRST (RULE-WISE AND LEFT TO RIGHT IN EVERY RULE)     */
 /*OCCURRENCE OF SYMBOL WITH ID id IN SYMBOL sle                     */
 /*RESULT IS STORED IN loc, A MEMORY LOCATION OF LEAST 2*sizeof(int) */
@@ -281,7 +459,6 @@ locate_symbol_in_sle(symbol_id id, symbol_list_entry *sle, int *loc)
 void 
 visit_symbol_list(symbol_list_entry *l, symbol_list_entry *symbol_table, int visited_value)
 {
-	int i;
 	rule_list_entry *rle = NULL;
 
 	assert(l != NULL);
@@ -291,15 +468,15 @@ visit_symbol_list(symbol_list_entry *l, symbol_list_entry *symbol_table, int vis
 
 	l->visited = visited_value;			
 
-	for(i=1; i <= l->rulecount; i++)
+	if(is_NT(l) == 0)
+		return;
+
+	/*THE RULE LIST IS WALKED DIRECTLY: get_rle() WOULD MAKE THIS QUADRATIC*/
+	for(rle = l->rules; rle != NULL; rle = rle->next)
 	{
 		int j;
 		symbol_list_entry *s;
 
-
-		rle = get_rle(l, i);
-		assert(rle != NULL);
-		
 		rle->visited = visited_value;
 		for(j=0; j < rle->length; j++)
 		{
@@ -437,12 +614,14 @@ is_DERIVES_NONTERMINALS(rule_list_entry *r)
 void
 insert_rle(symbol_list_entry *l, rule_list_entry *new_rle)
 {
-	short int i=0; 
+	int i=0; 
 	rule_list_entry **rle_pointer=NULL;
 	
 	assert(l != NULL);
 	assert(new_rle!= NULL);
 	assert(is_NT(l) == 1);
+	/*THE COMPILED GRAMMAR IMAGE IS READ-ONLY*/
+	assert(l->rules == NULL || l->rules->rhs == NULL);
 		
 	if(must_print_message(LISTOPS))
 		fprintf(message_stream, "inserting rle in: %d (%s)\n", l->id, l->name);
@@ -469,6 +648,7 @@ remove_rle(symbol_list_entry *l, int pos)
 	assert(pos>0);
 	assert(is_NT(l));
 	assert(l->rulecount >= 1);
+	assert(l->rules->rhs == NULL);
 
 	if(pos != 1)
 	{
@@ -489,6 +669,36 @@ remove_rle(symbol_list_entry *l, int pos)
 }
 
 
+/*REMOVE THE RLE FOLLOWING prev IN NT SYMBOL l (THE FIRST ONE IF prev IS NULL)*/
+/*UNLIKE remove_rle() IT DOES NOT WALK THE LIST                               */
+void
+remove_next_rle(symbol_list_entry *l, rule_list_entry *prev)
+{
+	rule_list_entry *r_to_rem = NULL;
+
+	assert(l != NULL);
+	assert(is_NT(l));
+	assert(l->rulecount >= 1);
+	assert(l->rules->rhs == NULL);
+
+	if(prev == NULL)
+	{
+		r_to_rem = l->rules;
+		l->rules = r_to_rem->next;
+	}
+	else
+	{
+		r_to_rem = prev->next;
+		assert(r_to_rem != NULL);
+		prev->next = r_to_rem->next;
+	}
+
+	l->rulecount--;
+	clean_rule(r_to_rem->rule);
+	free(r_to_rem);
+}
+
+
 /*FETCH AND RETURN RLE IN POSITION pos FROM RULE LIST OF SYMBOL POINTED BY l*/
 /*pos MUST BE GREATER THAN 0*/
 rule_list_entry *
@@ -505,6 +715,10 @@ get_rle(symbol_list_entry *l, int pos)
 
 	rle = l->rules;
 
+	/*IN A COMPILED GRAMMAR THE RULES OF A SYMBOL ARE CONTIGUOUS*/
+	if(rle->rhs != NULL)
+		return rle + (pos - 1);
+
 	while(--pos > 0)
 	{
 		rle = rle->next;
@@ -513,17 +727,36 @@ get_rle(symbol_list_entry *l, int pos)
 	return rle;
 }
 
+/*RETURNS THE POSITION OF rle AMONG ALL RULES OF THE COMPILED GRAMMAR*/
+/*RULE INDEXES ARE DENSE, FROM 0 TO THE NUMBER OF RULES MINUS ONE    */
+int
+get_rule_index(symbol_list_entry *symbol_table, rule_list_entry *rle)
+{
+	grammar_image *image = NULL;
+
+	assert(symbol_table != NULL);
+	assert(symbol_table->index != NULL);
+	assert(rle != NULL);
+
+	image = symbol_table->index->image;
+	assert(image != NULL);
+	assert(rle >= image->rules && rle < image->rules + image->rule_count);
+
+	return (int)(rle - image->rules);
+}
+
 /*LINK RLE l TO RLE new_rle AND RETURN l*/
 /*IF l IS NULL new_rle IS RETURNED      */
+/*IF last IS NOT NULL IT MUST BE THE LAST RLE IN l: THE LIST IS NOT WALKED*/
 rule_list_entry *
-link_rle(rule_list_entry *l, rule_list_entry *new_rle)
+link_rle(rule_list_entry *l, rule_list_entry *last, rule_list_entry *new_rle)
 {
 	rule_list_entry *rle = NULL;
 	
 	if(l == NULL)
 		return new_rle;
 	
-	rle=l;
+	rle = (last != NULL)? last : l;
 	while(rle->next !=NULL)
 	{
 		rle=rle->next;
@@ -534,6 +767,35 @@ link_rle(rule_list_entry *l, rule_list_entry *new_rle)
 }
 
 
+/*APPENDS ALL RLE LINKED FROM list TO THE RULE LIST OF NT SYMBOL l*/
+/*THE RULES OF l ARE WALKED ONLY ONCE, WHATEVER THE LENGTH OF list*/
+void
+insert_rle_list(symbol_list_entry *l, rule_list_entry *list)
+{
+	rule_list_entry **rle_pointer=NULL;
+
+	assert(l != NULL);
+	assert(is_NT(l) == 1);
+	assert(l->rules == NULL || l->rules->rhs == NULL);
+
+	if(must_print_message(LISTOPS))
+		fprintf(message_stream, "inserting rle list in: %d (%s)\n", l->id, l->name);
+
+	rle_pointer = &(l->rules);
+	while(*rle_pointer != NULL)
+	{
+		rle_pointer = &((*rle_pointer)->next);
+	}
+	*rle_pointer = list;
+
+	while(list != NULL)
+	{
+		l->rulecount++;
+		list = list->next;
+	}
+}
+
+
 
 /************************/
 /*RLE RELATED FUNCTIONS*/
@@ -560,6 +822,7 @@ void
 insert_symbol_rle(rule_list_entry *r, symbol_id sym)
 {
 	assert(r != NULL);
+	assert(r->rhs == NULL);
 	
 	insert_symbol_rule(r->rule, sym, r->length++);
 }
@@ -572,6 +835,7 @@ remove_symbol_rle(rule_list_entry *r, int pos)
 	rule_t *new_rule = NULL;
 	
 	assert(r != NULL);
+	assert(r->rhs == NULL);
 	assert(r->length > 0);
 	assert(pos < r->length);
 	assert(pos >= 0);
@@ -596,6 +860,9 @@ extract_symbol_rle(rule_list_entry *r, int pos)
 	assert(pos >= 0);
 	assert(pos < r->length);
 
+	if(r->rhs != NULL)
+		return r->rhs[pos];
+
 	return extract_symbol_rule(r->rule, pos);
 }
 
@@ -605,6 +872,7 @@ void
 modify_symbol_rle(rule_list_entry *rle, int pos, symbol_id new_value)
 {
 	assert(rle != NULL);
+	assert(rle->rhs == NULL);
 	assert(pos >= 0);
 	assert(pos < rle->length);
 	assert(new_value >= 0);
@@ -612,6 +880,75 @@ modify_symbol_rle(rule_list_entry *rle, int pos, symbol_id new_value)
 	modify_symbol_rule(rle->rule, pos, new_value);
 }
 
+/*FNV-1a HASH OF THE SYMBOLS IN RLE r. RULES WITH THE SAME SYMBOLS HASH THE SAME*/
+unsigned long
+hash_rle(rule_list_entry *r)
+{
+	unsigned long h = 2166136261UL;
+	rule_t *rule = NULL;
+	int i;
+
+	assert(r != NULL);
+
+	rule = r->rule;
+	for(i = 0; i < r->length; i++)
+	{
+		unsigned long s;
+
+		/*FOLLOW THE FRAGMENT CHAIN INSTEAD OF RESTARTING FROM THE HEAD*/
+		if(r->rhs != NULL)
+			s = (unsigned long) r->rhs[i];
+		else
+		{
+			if(i > 0 && i % (RULE_FRAGMENT_SIZE-1) == 0)
+				rule = (rule_t *) rule[RULE_FRAGMENT_SIZE-1];
+			s = (unsigned long) rule[i % (RULE_FRAGMENT_SIZE-1)];
+		}
+
+		h ^= s;
+		h *= 16777619UL;
+	}
+	h ^= (unsigned long) r->length;
+
+	return h;
+}
+
+
+/*RETURNS 1 IF RLE a AND b CONTAIN THE SAME SYMBOLS IN THE SAME ORDER, ELSE 0*/
+int
+equal_rle(rule_list_entry *a, rule_list_entry *b)
+{
+	rule_t *ra = NULL, *rb = NULL;
+	int i;
+
+	assert(a != NULL);
+	assert(b != NULL);
+
+	if(a->length != b->length)
+		return 0;
+
+	ra = a->rule;
+	rb = b->rule;
+	for(i = 0; i < a->length; i++)
+	{
+		symbol_id sa, sb;
+
+		if(i > 0 && i % (RULE_FRAGMENT_SIZE-1) == 0)
+		{
+			if(a->rhs == NULL)
+				ra = (rule_t *) ra[RULE_FRAGMENT_SIZE-1];
+			if(b->rhs == NULL)
+				rb = (rule_t *) rb[RULE_FRAGMENT_SIZE-1];
+		}
+		sa = (a->rhs != NULL)? a->rhs[i] : ra[i % (RULE_FRAGMENT_SIZE-1)];
+		sb = (b->rhs != NULL)? b->rhs[i] : rb[i % (RULE_FRAGMENT_SIZE-1)];
+
+		if(sa != sb)
+			return 0;
+	}
+	return 1;
+}
+
 /************************/
 /*RULE RELATED FUNCTIONS*/
 /************************/
@@ -631,7 +968,7 @@ insert_symbol_rule(rule_t *rule, symbol_id sym, int pos)
 	{
 		if(offset == 0 && fragment == 0)
 		{
-			rule[RULE_FRAGMENT_SIZE-1] = (rule_t) xmalloc(RULE_FRAGMENT_SIZE * sizeof(rule_t));
+			rule[RULE_FRAGMENT_SIZE-1] = (rule_t) initialize_new_rule();
 			rule = (rule_t *) rule[RULE_FRAGMENT_SIZE-1];
 			break;
 		}
@@ -719,29 +1056,150 @@ initialize_new_rule()
 	rule_t *rule = NULL;
 
 	rule = xmalloc(RULE_FRAGMENT_SIZE * sizeof(rule_t));
-	memset(rule, 0, RULE_FRAGMENT_SIZE);
+	memset(rule, 0, RULE_FRAGMENT_SIZE * sizeof(rule_t));
 
 	return rule;
 }
 
 
 
-/******************************************/
-/*LEXICON ARGZ STRUCTURE RELATED FUNCTIONS*/
-/******************************************/
+/*************************************/
+/*LEXICON STRUCTURE RELATED FUNCTIONS*/
+/*************************************/
 
 
 /*RETURNS A POINTER TO A NEWLY ALLOCATED LEXICON STRUCTURE*/
-lexicon_argz_structure *
-initialize_new_lexicon_argz_structure()
+lexicon_structure *
+initialize_new_lexicon_structure()
+{
+	lexicon_structure *lex = NULL;
+
+	lex = xmalloc(sizeof(lexicon_structure));
+	assert(lex != NULL);
+	memset(lex, 0, sizeof(lexicon_structure));
+
+	return lex;
+}
+
+
+/*APPENDS TO lex THE LEXICAL UNIT unit (NULL TERMINATED), DECODING IT'S */
+/*ESCAPE SEQUENCES ONCE AND FOR ALL                                    */
+void
+insert_lexicon_unit(lexicon_structure *lex, char *unit)
 {
-	lexicon_argz_structure *lazs = NULL;
+	size_t needed;
+
+	assert(lex != NULL);
+	assert(lex->mapped == 0);
+	assert(unit != NULL);
+
+	/*DECODING NEVER MAKES A UNIT LONGER*/
+	needed = strlen(unit);
+	if(lex->text_used + needed > lex->text_size)
+	{
+		size_t size = (lex->text_size == 0)? 256 : lex->text_size;
+
+		while(lex->text_used + needed > size)
+			size *= 2;
+
+		lex->text = realloc(lex->text, size);
+		if(lex->text == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+		lex->text_size = size;
+	}
 
-	lazs = xmalloc(sizeof(lexicon_argz_structure));
-	assert(lazs != NULL);
-	memset(lazs, 0, sizeof(lexicon_argz_structure));
+	if(lex->unit_count == lex->unit_size)
+	{
+		lex->unit_size = (lex->unit_size == 0)? 16 : 2 * lex->unit_size;
+		lex->unit_start = realloc(lex->unit_start, (lex->unit_size + 1) * sizeof(size_t));
+		if(lex->unit_start == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+		if(lex->unit_weight != NULL)
+		{
+			lex->unit_weight = realloc(lex->unit_weight, lex->unit_size * sizeof(unsigned int));
+			if(lex->unit_weight == NULL)
+				error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+		}
+	}
+	if(lex->unit_weight != NULL)
+	{
+		lex->unit_weight[lex->unit_count] = 1;
+	}
 
-	return lazs;
+	lex->unit_start[lex->unit_count] = lex->text_used;
+	lex->text_used += decode_escapes(unit, lex->text + lex->text_used);
+	lex->unit_count++;
+	lex->unit_start[lex->unit_count] = lex->text_used;
+}
+
+
+/*RETURNS THE BYTES OF THE pos-TH UNIT (COUNTING FROM ZERO) OF lex, AND*/
+/*STORES THEIR NUMBER IN length. THE BYTES ARE NOT NULL TERMINATED     */
+char *
+get_lexicon_unit(lexicon_structure *lex, int pos, size_t *length)
+{
+	char *unit = NULL;
+
+	assert(lex != NULL);
+	assert(pos >= 0 && pos < lex->unit_count);
+
+	unit = lex->text + lex->unit_start[pos];
+	*length = lex->unit_start[pos + 1] - lex->unit_start[pos];
+	while(lex->lines != 0 && *length > 0 && (unit[*length - 1] == '\n' || unit[*length - 1] == '\r'))
+		(*length)--;
+	return unit;
+}
+
+
+/*SETS THE WEIGHT OF THE pos-TH UNIT (COUNTING FROM ZERO) OF lex. UNITS */
+/*HAVE WEIGHT 1 BY DEFAULT; THE WEIGHTS ARE ONLY STORED ONCE ONE OF THEM*/
+/*IS DIFFERENT                                                          */
+void
+set_lexicon_unit_weight(lexicon_structure *lex, int pos, unsigned int weight)
+{
+	assert(lex != NULL);
+	assert(pos >= 0 && pos < lex->unit_count);
+	assert(weight > 0);
+
+	if(lex->unit_weight == NULL)
+	{
+		int i;
+
+		if(weight == 1)
+			return;
+
+		lex->unit_weight = xmalloc(lex->unit_size * sizeof(unsigned int));
+		for(i = 0; i < lex->unit_count; i++)
+		{
+			lex->unit_weight[i] = 1;
+		}
+	}
+	lex->unit_weight[pos] = weight;
+}
+
+
+/*FREES THE LEXICON STRUCTURE lex*/
+void
+clean_lexicon_structure(lexicon_structure *lex)
+{
+	assert(lex != NULL);
+
+	/*THE ARRAYS OF A LEXICON LOADED FROM A COMPILED GRAMMAR ARE NOT OWNED*/
+	if(lex->mapped == 2)
+	{
+		free(lex);
+		return;
+	}
+
+	if(lex->mapped != 0)
+		munmap(lex->text, lex->text_size);
+	else
+		free(lex->text);
+	free(lex->unit_start);
+	free(lex->unit_weight);
+	free(lex->alias_threshold);
+	free(lex->alias);
+	free(lex);
 }
 
 
@@ -760,15 +1218,26 @@ clean_symbol_list(symbol_list_entry *l)
 	if(l->next != NULL)
 		clean_symbol_list(l->next);
 
-	if(l->rules != NULL && l->id != 0 && is_NT(l))
+	/*RULES OF A COMPILED GRAMMAR ARE FREED WITH THE IMAGE*/
+	if(l->rules != NULL && l->id != 0 && is_NT(l) && l->rules->rhs == NULL)
 		clean_rle_list(l->rules);
 	else if(l->rules != NULL && l->id != 0 && is_LEXICAL(l))
-		free(((lexicon_argz_structure *)l->rules)->argz);
+		clean_lexicon_structure((lexicon_structure *) l->rules);
 
 	if(must_print_message(CLEAN_MAX))
 		fprintf(message_stream, "freeing symbol_list_entry ADDRESS: %p, ID: %d, NAME: %s\n", l, l->id, l->name);
 
-	free(l->name);
+	/*THE HEAD NODE IS FREED LAST: ALL NAMES GO AWAY WITH ITS ARENA*/
+	if(l->index != NULL)
+	{
+		free(l->index->symbols);
+		free(l->index->hash);
+		clean_arena(l->index->names);
+		if(l->index->image != NULL)
+			clean_grammar_image(l->index->image);
+		free(l->index);
+	}
+
 	free(l);	
 }
 
@@ -802,3 +1271,31 @@ void clean_rule(rule_t *r)
 	free(r);
 }
 
+
+/*FREES THE COMPILED GRAMMAR IMAGE*/
+void
+clean_grammar_image(grammar_image *image)
+{
+	assert(image != NULL);
+
+	/*ONLY THE RULES OF A LOADED IMAGE ARE NOT IN THE MAPPING*/
+	if(image->mapping != NULL)
+	{
+		free(image->rules);
+		munmap(image->mapping, image->mapping_size);
+		free(image);
+		return;
+	}
+
+	free(image->rhs);
+	free(image->rules);
+	free(image->rule_offset);
+	free(image->rule_num);
+	free(image->rule_lhs);
+	free(image->min_length);
+	free(image->rule_min_length);
+	free(image->text);
+	free(image->text_offset);
+	free(image->text_length);
+	free(image);
+}
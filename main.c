@@ -25,14 +25,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 /*GLOBAL VARIABLE DEFINITION*/
 /****************************/
 
-/*GLOBAL SYMBOL TABLE FOR SENTENCE GENERATION*/
-symbol_list_entry *symbol_table = NULL;
-/*ID OF STARTING SYMBOL OF TARGET GRAMMAR*/
-/*IT IS SET BY THE PARSER                */
-symbol_id starting_symbol = (symbol_id)0;
-
-/*VALUE SET BY LEXICON SCANNER TO SPECIFY WHERE TO APPEND LEXICON UNITS*/
-symbol_id current_symbol_for_lexicon;
+/*GENERATOR CONTEXT OF THE COMMAND LINE: GRAMMAR, OPTIONS AND STREAMS*/
+generator_context *context = NULL;
 
 /*STRUCTURES FOR CHARACTERIZING SYMBOL TYPES*/
 int rc_values[] = RC_VALUES;
@@ -42,28 +36,18 @@ char *rule_type_names[NUMBER_OF_RULE_TYPES] = RULE_TYPE_NAMES;
 
 /*STRUCTURES FOR VERBOSITY POLICY ENFORCEMENT*/
 int verb_policy[NUMBER_OF_SOURCES]=VERB_POLICY;
-int verbosity = DEFAULT_VERBOSITY;
 
 /*FLAG FOR DECIDING WHETHER TO PRINT SYMBOL TABLE PRIOR TO SENTENCE GENERATION*/ 
 short int print_table_flag = DEFAULT_PRINT_TABLE_FLAG;
-/*FLAG FOR INDICATING USE OF stdout INSTEAD OF FILE*/
-short int standard_output_flag = DEFAULT_STANDARD_OUTPUT_FLAG;
-/*FLAG FOR INDICATING USE OF AN EXTRA LEXICON FILE*/
-short int input_lexicon_flag = 0;
 /*FLAG FOR INDICATING THE REQUEST OF A COVERAGE SENTENCE GENERATION*/
 /*AS OPPOSED TO THE DEFAULT RANDOM GENERATION*/
 short int coverage_flag = 0;
-/*FLAG FOR INDICATING THAT SPACES SHOULD NOT BE GENERATED IN SENTENCES*/
-short int no_spaces_flag = 0;
+/*FLAG FOR REDUCING THE SET OF COVERAGE SENTENCES BEFORE IT IS WRITTEN*/
+short int minimize_flag = 0;
 
-/*I/O STREAMS USED THROUGHOUT THE SOURCES*/
-FILE *output_stream=NULL, *input_grammar_stream=NULL, *input_lexicon_stream=NULL;
-FILE *message_stream=NULL, *null_stream=NULL;
+/*THROW-AWAY STREAM*/
+FILE *null_stream=NULL;
 
-/*PATH (FILENAME) TO USER SPECIFIED INPUT GRAMMAR FILE*/
-char *input_grammar_file_path = NULL;
-/*PATH (FILENAME) TO USER SPECIFIED INPUT LEXICON FILE*/
-char *input_lexicon_file_path = NULL;
 /*PATH (FILENAME) TO USER SPECIFIED OUTPUT FILE*/
 char *output_file_path = NULL;
 
@@ -78,18 +62,22 @@ char *output_file_path = NULL;
 int
 main(int argc, char **argv)
 {
-	int i=0, j, at_exit_return=0;
+	int i=0, at_exit_return=0;
 	char *sentence_separator = DEFAULT_SENTENCE_SEPARATOR;
 	int repeat = DEFAULT_REPEAT;
+	int jobs = DEFAULT_JOBS;
+	int seed = -1;
 	symbol_list_entry *s = NULL;
+	generator_context *ctx = NULL;
 
 	/*REGISTER CLEANUP FUNCTION*/
 	at_exit_return = atexit(clean_up);
 	if(at_exit_return != 0)
 		error(UNEXPECTED_ERROR, 0, "could not register clean-up function");
 
-	/*ASSIGN MESSAGE STREAM DEFAULT FALLBACK*/
-	message_stream = stdout;
+	/*THE CONTEXT ASSIGNS THE MESSAGE STREAM DEFAULT FALLBACK*/
+	ctx = context = initialize_new_generator_context();
+	use_generator_context(ctx);
 
 	/*ASSIGN NULL STREAM TO DEFAULT LINUX THROW-AWAY FILE*/
 	null_stream = fopen(DEFAULT_NULL_PATH, "w");
@@ -104,26 +92,50 @@ main(int argc, char **argv)
 		int option_index=0;
 		static const struct option long_options[]= 
 		{	
+			{"boltzmann",	required_argument,	0,	'b'},
+			{"compile",	required_argument,	0,	'C'},
 			{"coverage",	no_argument,		0,	'c'},
 			{"help",	no_argument,		0,	'h'},
+			{"jobs",	required_argument,	0,	'j'},
+			{"criterion",	required_argument,	0,	'k'},
+			{"word-list",	required_argument,	0,	'l'},
+			{"length",	required_argument,	0,	'L'},
 			{"message",	required_argument,	0,	'm'},
+			{"minimize",	no_argument,		0,	'M'},
 			{"no-spaces",	no_argument,		0,	'n'},
 			{"output", 	required_argument,	0,	'o'},
 			{"print-tables",no_argument,		0,	'p'},
 			{"repeat",	required_argument, 	0, 	'r'},
+			{"seed",	required_argument,	0,	'R'},
 			{"separator",	optional_argument,	0,	's'},
+			{"state",	required_argument,	0,	'S'},
 			{"standard-output", no_argument,	0,	'O'},
+			{"tree",	required_argument,	0,	't'},
 			{"verbosity",	required_argument,	0,	'v'},
 			{"version",	no_argument,		0,	'e'},
 			{0,		0,			0,	0}
 		};
-		static const char *short_options = "cehm:no:Opr:s::v:";
+		static const char *short_options = "b:C:cehj:k:l:L:m:Mno:Opr:R:s::S:t:v:";
  
 		i=getopt_long(argc, argv, short_options, long_options, &option_index);
 		if(i==-1) break;
 		
 		switch(i)
 		{
+		case 'b':
+			read_length_range(optarg, &(ctx->boltzmann_min_size), &(ctx->boltzmann_max_size));
+			/*A SINGLE SIZE IS THE MIDDLE OF THE RANGE*/
+			if(ctx->boltzmann_min_size == ctx->boltzmann_max_size)
+			{
+				int delta = (int)((long) ctx->boltzmann_max_size * BOLTZMANN_TOLERANCE_PERCENTAGE / 100);
+
+				ctx->boltzmann_min_size -= delta;
+				ctx->boltzmann_max_size += delta;
+			}
+			break;
+		case 'C':
+			ctx->compiled_grammar_file_path = optarg;
+			break;
 		case 'c':
 			coverage_flag = 1;
 			break;
@@ -133,14 +145,34 @@ main(int argc, char **argv)
 		case 'h':
 			print_usage();
 			exit(0);
+		case 'j':
+			jobs = read_number(optarg);
+			if(jobs < 1)
+				error(BAD_ARGUMENTS, 0, "%s", "the number of jobs must be at least 1");
+			break;
+		case 'k':
+			ctx->criterion = read_coverage_criterion(optarg);
+			break;
+		case 'l':
+			ctx->word_list = realloc(ctx->word_list, (ctx->word_list_count + 1) * sizeof(char *));
+			if(ctx->word_list == NULL)
+				error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+			ctx->word_list[ctx->word_list_count++] = optarg;
+			break;
+		case 'L':
+			read_length_range(optarg, &(ctx->sentence_min_length), &(ctx->sentence_max_length));
+			break;
 		case 'm':
-			message_stream = open_file_write(optarg);
+			ctx->message_stream = open_file_write(optarg);
+			break;
+		case 'M':
+			minimize_flag = 1;
 			break;
 		case 'n':
-			no_spaces_flag = 1;
+			ctx->no_spaces_flag = 1;
 			break;
 		case 'o':
-			if(standard_output_flag == 1)
+			if(ctx->standard_output_flag == 1)
 				error(BAD_ARGUMENTS, 0, "previously used -O option, incompatible with -o");
 			else
 			{
@@ -152,8 +184,8 @@ main(int argc, char **argv)
 				error(BAD_ARGUMENTS, 0, "previously used -o option, incompatible with -O");
 			else
 			{
-				output_stream = stdout;
-				standard_output_flag = 1;
+				ctx->output_stream = stdout;
+				ctx->standard_output_flag = 1;
 				break;
 			}
 		case 'p':
@@ -162,41 +194,56 @@ main(int argc, char **argv)
 		case 'r':
 			repeat = read_number(optarg);
 			break;
+		case 'R':
+			seed = read_number(optarg);
+			break;
 		case 's':
 			if(optarg != NULL)
 				sentence_separator = optarg;
 			else
 				sentence_separator = "";
 			break;
+		case 'S':
+			ctx->coverage_state_file_path = optarg;
+			break;
+		case 't':
+			ctx->parse_tree_mode = read_tree_mode(optarg);
+			break;
 		case 'v':
-			verbosity=read_number(optarg);
-			verbosity=(verbosity > MAX_VERBOSITY)? MAX_VERBOSITY:verbosity;
+			ctx->verbosity=read_number(optarg);
+			ctx->verbosity=(ctx->verbosity > MAX_VERBOSITY)? MAX_VERBOSITY:ctx->verbosity;
 			break;
 		case '?':
 			/*ERROR MESSAGE ALREADY PRINTED BY getopt_long*/
 			exit(BAD_ARGUMENTS);
 		} 	
 	}
+
+	/*FROM NOW ON MESSAGES FOLLOW THE OPTIONS*/
+	use_generator_context(ctx);
+
+	if(ctx->sentence_max_length >= 0 && ctx->boltzmann_max_size >= 0)
+		error(BAD_ARGUMENTS, 0, "%s", "the -L and -b options are incompatible");
 	
 	/*TEST IF PROGRAM HAS BEEN SUPPLIED WITH ENOUGH NON-OPTION ARGUMENTS*/
 	if(optind >= argc)
 		error(BAD_ARGUMENTS, 0, "%s", "not enough arguments");
 
 	/*ASSIGN PATH NAME AND OPEN STREAM FOR GRAMMAR INPUT FILE*/
-	input_grammar_file_path = argv[optind];
-	assert(input_grammar_file_path != NULL);
-	input_grammar_stream = open_file_read(input_grammar_file_path);
+	ctx->input_grammar_file_path = argv[optind];
+	assert(ctx->input_grammar_file_path != NULL);
+	ctx->input_grammar_stream = open_file_read(ctx->input_grammar_file_path);
 
 	/*IF PROVIDED, THE LEXICON FILE IS OPENED            */
 	/*NOTE THAT IT MUST PROVIDED -AFTER- THE GRAMMAR FILE*/
 	if(argc > optind+1)
 	{
-		input_lexicon_file_path = argv[optind+1];
-		input_lexicon_flag = 1;
-		assert(input_lexicon_file_path != NULL);		
+		ctx->input_lexicon_file_path = argv[optind+1];
+		ctx->input_lexicon_flag = 1;
+		assert(ctx->input_lexicon_file_path != NULL);		
 
 		/*OPEN STREAM AND CHECK FOR ERRORS*/
-		input_lexicon_stream = open_file_read(input_lexicon_file_path);		
+		ctx->input_lexicon_stream = open_file_read(ctx->input_lexicon_file_path);		
 	}
 
 	/*IF OUTPUT PATH NOT ASSIGNED, A DEFAULT FALLBACK IS USED*/
@@ -205,51 +252,55 @@ main(int argc, char **argv)
 		output_file_path = DEFAULT_OUTPUT_PATH;
 	}
 	
-	/*CREATE INTERNAL DATA STRUCTURE FROM INPUT GRAMMAR FILE*/
-	build_tables();
+	/*CREATE INTERNAL DATA STRUCTURE FROM INPUT GRAMMAR FILE, CHECK IT'S   */
+	/*CONSISTENCY AND FREEZE IT IN A FLAT, READ-ONLY IMAGE FOR GENERATION  */
+	/*FUNCTION DOES NOT RETURN IN CASE OF ERRORS                           */
+	load_grammar(ctx);
 
-	/*CHECK CONSISTENCY OF DATA STRUCTURE IN MEMORY*/
-	/*FUNCTION DOES NOT RETURN IN CASE OF ERRORS*/
-	check_grammar(symbol_table, starting_symbol);
+	/*IF REQUESTED, SAVE THE COMPILED GRAMMAR FOR LATER RUNS*/
+	if(ctx->compiled_grammar_file_path != NULL)
+	{
+		save_grammar_image(ctx, ctx->compiled_grammar_file_path);
+	}
 
 	/*NOW WE SURELY HAVE AN OUTPUT PATH, AND THE PROGRAM HAS RECEIVED GOOD ARGUMENTS*/
 	/*SO OPEN THE SELECTED OUTPUT FILE. WE ARE SURE AT THIS POINT WE WON'T CREATE   */
 	/*A USELESS FILE                                                                */
-	if(standard_output_flag == 0)
+	if(ctx->standard_output_flag == 0)
 	{
-		output_stream = fopen(output_file_path, "w");
+		ctx->output_stream = fopen(output_file_path, "w");
 	}
-	if (output_stream == NULL)
+	if (ctx->output_stream == NULL)
 	{
 		error(UNEXPECTED_ERROR, errno, "%s", output_file_path);
 	}
 
 
 	/*PRELIMINARY ASSERTION CHECKING*/	
-	assert(symbol_table != NULL);
+	assert(ctx->symbol_table != NULL);
 	assert(message_stream != NULL);
-	assert(output_stream != NULL);
-	assert(input_grammar_stream != NULL);
+	assert(ctx->output_stream != NULL);
+	assert(ctx->input_grammar_stream != NULL);
 	assert(repeat >= 0);
-	assert(starting_symbol !=0);
-	assert(starting_symbol <= (symbol_table->rulecount));
+	assert(ctx->starting_symbol !=0);
+	assert(ctx->starting_symbol <= (ctx->symbol_table->rulecount));
 
 
 	/*PRINTING OF GRAMMAR STRUCTURE TABLE*/
 	if(print_table_flag == 1)
 	{	
 		fprintf(message_stream, "\n");
-		print_symbol_list(symbol_table);
+		print_symbol_list(ctx->symbol_table, ctx->starting_symbol);
 		
-		if(input_lexicon_flag != 0)
+		if(ctx->lexicon_flag != 0)
 		{
 			fprintf(message_stream, "\n");
-			print_lexicon_table(symbol_table);
+			print_lexicon_table(ctx->symbol_table);
 		}
 	}
 
 	/*EXTRACTING STARTING SYMBOL*/
-	s = get_symbol(symbol_table, starting_symbol);
+	s = get_symbol(ctx->symbol_table, ctx->starting_symbol);
 	assert(s != NULL);
 	if(repeat > 0 || coverage_flag == 1)
 	{
@@ -257,57 +308,27 @@ main(int argc, char **argv)
 			fprintf(message_stream, "starting sentence generation, starting symbol is: %s\n", s->name);
 	}
 
-	/*INITIALIZE RANDOM NUMBER GENERATOR*/
-	set_random_seed();
+	/*INITIALIZE RANDOM NUMBER GENERATOR, FROM THE CLOCK UNLESS -R IS SET*/
+	ctx->seed = set_random_seed(seed);
 
 	/*MAIN CICLE*/
 	if(coverage_flag == 1)
 	{
-		int count = 1;
-
-		if(must_print_message(MAIN))
-			fprintf(message_stream, "sentence %d:\n", count);
-
-		while(1)
-		{
-			rule_list_entry *r_check = NULL, *r_check_deep = NULL;
-			purdom(starting_symbol, symbol_table);
-
-			r_check = get_unvisited_rle(s);
-			r_check_deep = get_with_deep_unvisited_rle(s, symbol_table);
-
-			if(r_check == NULL && r_check_deep == NULL)
-			{
-				if(must_print_message(MAIN))
-				{
-					fprintf(message_stream, "complete coverage reached\n");
-				}
-				break;
-			}
-			else
-			{
-				if(must_print_message(MAIN))
-				{
-					fprintf(message_stream, "more sentences needed, sentence %d:\n", ++count);
-				}
-
-				fprintf(output_stream, sentence_separator);
-			}
-		}
+		generate_coverage(ctx, sentence_separator, minimize_flag, jobs);
 	}
 	else
 	{
-		for(j=0; j < repeat; j++)
-		{
-			symbol_list_entry* test_sle = get_symbol_by_name(symbol_table, "add");
-			symbol_id test_symb = test_sle->id;
-			// grow(starting_symbol, symbol_table);
-			grow(test_symb, symbol_table);
-			if(j < repeat-1)
-				fprintf(output_stream, sentence_separator);
-		}
-		fputs("\n", output_stream);
+		/*SENTENCES OF A GIVEN LENGTH NEED THE DERIVATION COUNTS FIRST*/
+		if(ctx->sentence_max_length >= 0 && repeat > 0)
+			build_length_table(ctx);
+		else if(ctx->boltzmann_max_size >= 0 && repeat > 0)
+			tune_boltzmann_sampler(ctx);
+
+		/*THE SENTENCES ARE THE SAME WHATEVER THE NUMBER OF THREADS*/
+		generate_batch(ctx, repeat, jobs, sentence_separator);
+		fputs("\n", ctx->output_stream);
 	}
+
 	/*CLEAN UP AND EXIT*/
 	exit(EXIT_SUCCESS);
 }
@@ -318,49 +339,55 @@ void
 clean_up(void)
 {
 	int i=0;
+	generator_context *ctx = context;
 	
+	if(ctx == NULL)
+		return;
+
 	/*FREE DINAMICALLY ALLOCATED MEMORY IN DATA STRUCTURES*/
 	if(must_print_message(CLEAN_MIN))
 		fprintf(message_stream, "starting cleaning...\n");
 
-	if(symbol_table != NULL)
+	if(ctx->symbol_table != NULL)
 	{
-		clean_symbol_list(symbol_table);
+		clean_symbol_list(ctx->symbol_table);
+		ctx->symbol_table = NULL;
 	}
 
 	if(must_print_message(CLEAN_MIN))
 		fprintf(message_stream, "done cleaning, closing file descriptors and exiting...\n");
 
 	/*CLOSE FILE DESCRIPTORS (IF OPEN) AND CHECK FOR ERRORS*/
-	if(message_stream != NULL)
+	if(ctx->message_stream != NULL)
 	{
-		i = fclose(message_stream);
+		i = fclose(ctx->message_stream);
+		message_stream = NULL;
 		if(i != 0)
 			error(UNEXPECTED_ERROR, errno, "%s", "failed to close file descriptor for message stream");
 	}
 
-	if(input_grammar_stream != NULL)
+	if(ctx->input_grammar_stream != NULL)
 	{
-		i = fclose(input_grammar_stream);
+		i = fclose(ctx->input_grammar_stream);
 		if(i != 0)
 			error(UNEXPECTED_ERROR, errno, "%s", "failed to close file descriptor for input grammar stream");
 	}	
 
-	if(input_lexicon_flag == 1)
+	if(ctx->input_lexicon_flag == 1)
 	{
-		if(input_lexicon_stream != NULL)
+		if(ctx->input_lexicon_stream != NULL)
 		{
-			i = fclose(input_lexicon_stream);
+			i = fclose(ctx->input_lexicon_stream);
 			if(i != 0)
 				error(UNEXPECTED_ERROR, errno, "%s", "failed to close file descriptor for input lexicon stream");
 		}
 	}
 
-	if(standard_output_flag == 0)
+	if(ctx->standard_output_flag == 0)
 	{
-		if(output_stream != NULL)
+		if(ctx->output_stream != NULL)
 		{
-			i = fclose(output_stream);
+			i = fclose(ctx->output_stream);
 			if(i != 0)
 				error(UNEXPECTED_ERROR, errno, "%s", "failed to close file descriptor for output stream");
 		}
@@ -372,4 +399,7 @@ clean_up(void)
 		if(i != 0)
 			error(UNEXPECTED_ERROR, errno, "%s", "failed to close file descriptor for throw-away stream");
 	}
+
+	context = NULL;
+	clean_generator_context(ctx);
 }
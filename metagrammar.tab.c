@@ -76,26 +76,14 @@
 #include <generation.h>
 
 /*SHORTHAND MACROS*/
-#define ERROR(M,L) error(BAD_INPUT,0,"%s: line %d: %s",input_grammar_file_path,L,M)
+#define ERROR(M,L) error(BAD_INPUT,0,"%s: line %d: %s",parsing_context->input_grammar_file_path,L,M)
 #define remove_quotes(M) M+=sizeof(char);M[yyleng-2]='\0'
 
-/*WORKING VARIABLES*/
-symbol_list_entry *s=NULL;
-rule_list_entry *r=NULL;
-rule_list_entry *r_list=NULL;
-int r_count = 0;
+/*WORKING VARIABLE*/
+static symbol_list_entry *s=NULL;
 
-/*GLOBAL VARIABLES DEFINED IN CALLING FUNCTION*/
-
-/*POINTER TO SYMBOL TABLE TO BE CONSTRUCTED*/
-extern symbol_list_entry *symbol_table;
-/*ID OF STARTING SYMBOL WILL BE PLACED HERE*/
-extern symbol_id starting_symbol;
-/*NAME OF THE INPUT FILE, FOR ERROR REPORTING PURPOSES*/
-extern char *input_grammar_file_path;
-
-/*GLOBAL STREAM FOR MESSAGES*/
-extern FILE *message_stream;
+/*THE SYMBOL TABLE, THE STARTING SYMBOL AND THE RULES BEING COLLECTED*/
+/*ARE THOSE OF parsing_context, SET BY build_tables()                */
 
 /*STANDARD GLOBAL VARIABLES DEFINED IN FLEX SCANNER*/
 extern char *yytext;
@@ -103,7 +91,7 @@ extern int yyleng;
 extern int yylineno;
 
 
-#line 107 "metagrammar.tab.c"
+#line 95 "metagrammar.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -560,11 +548,11 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    74,    74,    79,    86,    73,    97,   101,   108,   117,
-     118,   119,   124,   130,   131,   132,   138,   144,   155,   161,
-     162,   164,   201,   246,   250,   255,   260,   266,   267,   268,
-     270,   271,   273,   274,   276,   297,   313,   329,   347,   350,
-     363,   376,   380,   394,   399,   404,   409
+       0,    62,    62,    67,    74,    61,    85,    89,    96,   105,
+     106,   107,   112,   118,   119,   120,   126,   132,   143,   149,
+     150,   152,   189,   234,   238,   243,   248,   254,   255,   256,
+     258,   259,   261,   262,   264,   281,   297,   314,   333,   336,
+     349,   362,   366,   380,   385,   390,   395
 };
 #endif
 
@@ -1550,65 +1538,65 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* $@1: %empty  */
-#line 74 "metagrammar.y"
+#line 62 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced declarations section\n");
 		}
-#line 1559 "metagrammar.tab.c"
+#line 1547 "metagrammar.tab.c"
     break;
 
   case 3: /* $@2: %empty  */
-#line 79 "metagrammar.y"
+#line 67 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced first PART_SEPARATOR\n");
 			/*INITIALIZE WORKING VARIABLE r*/
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		}
-#line 1570 "metagrammar.tab.c"
+#line 1558 "metagrammar.tab.c"
     break;
 
   case 4: /* $@3: %empty  */
-#line 86 "metagrammar.y"
+#line 74 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced grammar section\n");
 		}
-#line 1579 "metagrammar.tab.c"
+#line 1567 "metagrammar.tab.c"
     break;
 
   case 5: /* yfile: declarations $@1 PART_SEPARATOR $@2 grammar $@3 rest_of_file  */
-#line 91 "metagrammar.y"
+#line 79 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced rest_of_file section...done!\n");
 		}
-#line 1588 "metagrammar.tab.c"
+#line 1576 "metagrammar.tab.c"
     break;
 
   case 6: /* rest_of_file: %empty  */
-#line 97 "metagrammar.y"
+#line 85 "metagrammar.y"
                 {
 			/*PROGRAM DOES NOT CARE ABOUT WHAT FOLLOWS THE GRAMMAR SECTION*/
 			YYACCEPT;
 		}
-#line 1597 "metagrammar.tab.c"
+#line 1585 "metagrammar.tab.c"
     break;
 
   case 7: /* rest_of_file: PART_SEPARATOR  */
-#line 102 "metagrammar.y"
+#line 90 "metagrammar.y"
                 {
 			/*PROGRAM DOES NOT CARE ABOUT WHAT FOLLOWS THE GRAMMAR SECTION*/
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced second PART_SEPARATOR\n");
 			YYACCEPT;
 		}
-#line 1608 "metagrammar.tab.c"
+#line 1596 "metagrammar.tab.c"
     break;
 
   case 8: /* rest_of_file: error  */
-#line 109 "metagrammar.y"
+#line 97 "metagrammar.y"
                 {
 			if(must_print_message(WARNING))
 			{
@@ -1616,70 +1604,70 @@ yyreduce:
 			}
 			return(0);
 		}
-#line 1620 "metagrammar.tab.c"
+#line 1608 "metagrammar.tab.c"
     break;
 
   case 11: /* declarations: token_declaration declarations  */
-#line 120 "metagrammar.y"
+#line 108 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "more declarations follow...\n");
 		}
-#line 1629 "metagrammar.tab.c"
+#line 1617 "metagrammar.tab.c"
     break;
 
   case 12: /* declarations: start_declaration declarations2  */
-#line 125 "metagrammar.y"
+#line 113 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "more declarations follow...\n");
 		}
-#line 1638 "metagrammar.tab.c"
+#line 1626 "metagrammar.tab.c"
     break;
 
   case 15: /* declarations2: declarations2 token_declaration  */
-#line 133 "metagrammar.y"
+#line 121 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "more declarations follow...(no more start declarations)\n");
 		}
-#line 1647 "metagrammar.tab.c"
+#line 1635 "metagrammar.tab.c"
     break;
 
   case 16: /* start_declaration: START_DECL start_symbol optional_semicolon  */
-#line 139 "metagrammar.y"
+#line 127 "metagrammar.y"
                 {
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced start declaration\n");
 		}
-#line 1656 "metagrammar.tab.c"
+#line 1644 "metagrammar.tab.c"
     break;
 
   case 17: /* start_symbol: IDENTIFIER  */
-#line 145 "metagrammar.y"
+#line 133 "metagrammar.y"
                 {
 			symbol_list_entry *s = NULL;
 
-			s = get_symbol(symbol_table, yyvsp[0]);
+			s = get_symbol(parsing_context->symbol_table, yyvsp[0]);
 			assert(s != NULL);
 			
 			set_symbol_type(s, NT);
-			starting_symbol = s->id;
+			parsing_context->starting_symbol = s->id;
 		}
-#line 1670 "metagrammar.tab.c"
+#line 1658 "metagrammar.tab.c"
     break;
 
   case 18: /* token_declaration: TOKEN_DECL token_list optional_semicolon  */
-#line 156 "metagrammar.y"
+#line 144 "metagrammar.y"
                         {
 				if(must_print_message(PARSER))
 					fprintf(message_stream, "reduced token declaration\n");
 			}
-#line 1679 "metagrammar.tab.c"
+#line 1667 "metagrammar.tab.c"
     break;
 
   case 21: /* token: IDENTIFIER  */
-#line 165 "metagrammar.y"
+#line 153 "metagrammar.y"
                 {
 			symbol_list_entry *s = NULL;
 
@@ -1687,7 +1675,7 @@ yyreduce:
 
 			assert(yyvsp[0] > 0);	
 
-			s = get_symbol(symbol_table, yyvsp[0]);
+			s = get_symbol(parsing_context->symbol_table, yyvsp[0]);
 			assert(s != NULL);
 
 			if(is_UNDEFINED(s))
@@ -1695,7 +1683,7 @@ yyreduce:
 				/*UNENCOUNTERED DECLARATION*/
 				set_symbol_type(s, LEXICAL);
 			}
-			else if(is_NT(s) && starting_symbol == yyvsp[0])
+			else if(is_NT(s) && parsing_context->starting_symbol == yyvsp[0])
 			{
 				/*ATTEMPTING TO DECLARE STARTING SYMBOL AS A TOKEN*/
 				ERROR("token already declared as starting symbol", (yylsp[0]).first_line);
@@ -1716,11 +1704,11 @@ yyreduce:
 				assert(0);
 			}
 		}
-#line 1720 "metagrammar.tab.c"
+#line 1708 "metagrammar.tab.c"
     break;
 
   case 22: /* token: IDENTIFIER somehow_quoted_literal  */
-#line 202 "metagrammar.y"
+#line 190 "metagrammar.y"
                 {
 			symbol_list_entry *s = NULL, *l = NULL;
 			rule_list_entry *rle = NULL;
@@ -1730,8 +1718,8 @@ yyreduce:
 			assert(yyvsp[-1] > 0);
 			assert(yyvsp[0] > 0);
 
-			s = get_symbol(symbol_table, yyvsp[-1]);
-			l = get_symbol(symbol_table, yyvsp[0]);
+			s = get_symbol(parsing_context->symbol_table, yyvsp[-1]);
+			l = get_symbol(parsing_context->symbol_table, yyvsp[0]);
 
 			assert(s != NULL);
 			assert(l != NULL);
@@ -1741,7 +1729,7 @@ yyreduce:
 				/*UNENCOUNTERED DECLARATION*/
 				set_symbol_type(s, NT);
 			}
-			else if(is_NT(s) && starting_symbol == yyvsp[-1])
+			else if(is_NT(s) && parsing_context->starting_symbol == yyvsp[-1])
 			{
 				/*ATTEMPTING TO DECLARE STARTING SYMBOL AS A TOKEN*/
 				ERROR("token already declared as starting symbol", (yylsp[-1]).first_line);
@@ -1765,73 +1753,69 @@ yyreduce:
 			insert_symbol_rle(rle, yyvsp[0]);
 			insert_rle(s, rle);
 		}
-#line 1769 "metagrammar.tab.c"
+#line 1757 "metagrammar.tab.c"
     break;
 
   case 23: /* token: somehow_quoted_literal  */
-#line 247 "metagrammar.y"
+#line 235 "metagrammar.y"
                 {
 			/*NOTHING TO BE DONE, CHECKS PERFORMED BY SCANNER*/
 		}
-#line 1777 "metagrammar.tab.c"
+#line 1765 "metagrammar.tab.c"
     break;
 
   case 24: /* token: ERROR_RESERVED_TOKEN  */
-#line 251 "metagrammar.y"
+#line 239 "metagrammar.y"
                 {
 			/*NOTHING TO BE DONE*/
 		}
-#line 1785 "metagrammar.tab.c"
+#line 1773 "metagrammar.tab.c"
     break;
 
   case 25: /* somehow_quoted_literal: SINGLE_QUOTED_LITERAL  */
-#line 256 "metagrammar.y"
+#line 244 "metagrammar.y"
                         {
 				assert(yyvsp[0] > 0);
 				yyval = yyvsp[0];
 			}
-#line 1794 "metagrammar.tab.c"
+#line 1782 "metagrammar.tab.c"
     break;
 
   case 26: /* somehow_quoted_literal: DOUBLE_QUOTED_LITERAL  */
-#line 261 "metagrammar.y"
+#line 249 "metagrammar.y"
                         {
 				assert(yyvsp[0] > 0);
 				yyval = yyvsp[0];
 			}
-#line 1803 "metagrammar.tab.c"
+#line 1791 "metagrammar.tab.c"
     break;
 
   case 34: /* definition: result ':' rule_list ';'  */
-#line 277 "metagrammar.y"
+#line 265 "metagrammar.y"
                 {
-			s = get_symbol(symbol_table, yyvsp[-3]);
+			s = get_symbol(parsing_context->symbol_table, yyvsp[-3]);
 			assert(s != NULL);
 			
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced rule definition for symbol: %d (%s)\n", s->id, s->name);
 
-			while(r_list != NULL)
-			{	
-				assert(s != NULL);
-
-				insert_rle(s, r_list);
-				r_list = r_list->next;
-			}
+			insert_rle_list(s, parsing_context->r_list);
+			parsing_context->r_list = NULL;
+			parsing_context->r_last = NULL;
 
 			/*MUST SET STARTING SYMBOL IF NOT SET BY %start DECLARATION*/
-			if(starting_symbol == 0)
-				starting_symbol = yyvsp[-3];
+			if(parsing_context->starting_symbol == 0)
+				parsing_context->starting_symbol = yyvsp[-3];
 		}
-#line 1827 "metagrammar.tab.c"
+#line 1811 "metagrammar.tab.c"
     break;
 
   case 35: /* result: IDENTIFIER  */
-#line 298 "metagrammar.y"
+#line 282 "metagrammar.y"
                 {
 			symbol_list_entry *s=NULL;
 			
-			s=get_symbol(symbol_table, yyvsp[0]);
+			s=get_symbol(parsing_context->symbol_table, yyvsp[0]);
 			assert(s != NULL);
 
 			/*RESULT OF A RULE MUST BE A NON TERMINAL SYMBOL*/
@@ -1842,146 +1826,148 @@ yyreduce:
 			set_symbol_type(s, NT);
 			yyval = yyvsp[0];
 		}
-#line 1846 "metagrammar.tab.c"
+#line 1830 "metagrammar.tab.c"
     break;
 
   case 36: /* rule_list: rule_list '|' rule  */
-#line 314 "metagrammar.y"
+#line 298 "metagrammar.y"
                 {
 			/*PUSH THE RULE ON THE LIST AND CREATE A NEW BLANK ONE*/
 			if(yyvsp[0] >= 0)
 			{
-				r_list = link_rle(r_list, r);
+				parsing_context->r_list = link_rle(parsing_context->r_list, parsing_context->r_last, parsing_context->r);
+				parsing_context->r_last = parsing_context->r;
 			}
 			else
 			{	
 				if(must_print_message(PARSER))
 					fprintf(message_stream, "found rule containing 'error' reserved keyword\n");
-				clean_rle_list(r);
+				clean_rle_list(parsing_context->r);
 			}
 
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		}
-#line 1866 "metagrammar.tab.c"
+#line 1851 "metagrammar.tab.c"
     break;
 
   case 37: /* rule_list: rule  */
-#line 330 "metagrammar.y"
+#line 315 "metagrammar.y"
                 {
 			/*PUSH THE RULE ON THE LIST AND CREATE A NEW BLANK ONE*/
 			if(yyvsp[0] >= 0)
 			{
-				r_list = link_rle(r_list, r);
+				parsing_context->r_list = link_rle(parsing_context->r_list, parsing_context->r_last, parsing_context->r);
+				parsing_context->r_last = parsing_context->r;
 			}
 			else
 			{	
 				if(must_print_message(PARSER))
 					fprintf(message_stream, "found rule containing 'error' reserved keyword\n");
-				clean_rle_list(r);
+				clean_rle_list(parsing_context->r);
 			}
 
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		}
-#line 1886 "metagrammar.tab.c"
+#line 1872 "metagrammar.tab.c"
     break;
 
   case 38: /* rule: %empty  */
-#line 347 "metagrammar.y"
+#line 333 "metagrammar.y"
                 { 
 			yyval = 0;
 		}
-#line 1894 "metagrammar.tab.c"
+#line 1880 "metagrammar.tab.c"
     break;
 
   case 39: /* rule: component_list  */
-#line 351 "metagrammar.y"
+#line 337 "metagrammar.y"
                 {
 			assert(yyvsp[0] != 0);
 			yyval = yyvsp[0];
 		}
-#line 1903 "metagrammar.tab.c"
+#line 1889 "metagrammar.tab.c"
     break;
 
   case 40: /* component_list: component_list component  */
-#line 364 "metagrammar.y"
+#line 350 "metagrammar.y"
                 {
 			/*INSERT SYMBOL FOUND IN RULE BEING CONSTRUCTED*/
 			assert(yyvsp[0] != 0);
 
 			if(yyvsp[0] > 0)
 			{
-				insert_symbol_rle(r, (symbol_id)yyvsp[0]);
+				insert_symbol_rle(parsing_context->r, (symbol_id)yyvsp[0]);
 			}
 			yyval = yyvsp[-1] * yyvsp[0];
 			if(yyval > 1)
 				yyval = 1;
 		}
-#line 1920 "metagrammar.tab.c"
+#line 1906 "metagrammar.tab.c"
     break;
 
   case 41: /* component_list: component_list component SET_SYM_VAL  */
-#line 377 "metagrammar.y"
+#line 363 "metagrammar.y"
         {
             fprintf(message_stream, "found val (2) %s\n", yytext);
         }
-#line 1928 "metagrammar.tab.c"
+#line 1914 "metagrammar.tab.c"
     break;
 
   case 42: /* component_list: component  */
-#line 381 "metagrammar.y"
+#line 367 "metagrammar.y"
                 {
 			/*INSERT SYMBOL FOUND IN LIST IN RULE BEING CONSTRUCTED*/
 			assert(yyvsp[0] != 0);
 
 			if(yyvsp[0] > 0)
 			{
-				insert_symbol_rle(r, (symbol_id)yyvsp[0]);
+				insert_symbol_rle(parsing_context->r, (symbol_id)yyvsp[0]);
 			}
 			yyval = yyvsp[0];
 			if(yyval > 1)
 				yyval = 1;
 			
 		}
-#line 1946 "metagrammar.tab.c"
+#line 1932 "metagrammar.tab.c"
     break;
 
   case 43: /* component_list: component SET_SYM_VAL  */
-#line 395 "metagrammar.y"
+#line 381 "metagrammar.y"
         {
             fprintf(message_stream, "found val (3) %s\n", yytext);
         }
-#line 1954 "metagrammar.tab.c"
+#line 1940 "metagrammar.tab.c"
     break;
 
   case 44: /* component: IDENTIFIER  */
-#line 400 "metagrammar.y"
+#line 386 "metagrammar.y"
                 {
 			assert(yyvsp[0] > 0);
 			yyval = yyvsp[0];
 		}
-#line 1963 "metagrammar.tab.c"
+#line 1949 "metagrammar.tab.c"
     break;
 
   case 45: /* component: somehow_quoted_literal  */
-#line 405 "metagrammar.y"
+#line 391 "metagrammar.y"
                 {
 			assert(yyvsp[0] > 0);
 			yyval = yyvsp[0];
 		}
-#line 1972 "metagrammar.tab.c"
+#line 1958 "metagrammar.tab.c"
     break;
 
   case 46: /* component: ERROR_RESERVED_TOKEN  */
-#line 410 "metagrammar.y"
+#line 396 "metagrammar.y"
                 {
 			assert(yyvsp[0] < 0);
 			yyval = yyvsp[0];
 		}
-#line 1981 "metagrammar.tab.c"
+#line 1967 "metagrammar.tab.c"
     break;
 
 
-#line 1985 "metagrammar.tab.c"
+#line 1971 "metagrammar.tab.c"
 
       default: break;
     }
@@ -2210,12 +2196,12 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 415 "metagrammar.y"
+#line 401 "metagrammar.y"
 
 
 int yyerror(YYLTYPE *locp, char const *s)
 {
-	fprintf(stderr, "%s: line %d: syntax error: found \"%s\", expecting: \"%s\"\n", input_grammar_file_path, locp->last_line, yytext, s);
+	fprintf(stderr, "%s: line %d: syntax error: found \"%s\", expecting: \"%s\"\n", parsing_context->input_grammar_file_path, locp->last_line, yytext, s);
 	
 	return 1;
 }
@@ -27,26 +27,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <generation.h>
 
 /*SHORTHAND MACROS*/
-#define ERROR(M,L) error(BAD_INPUT,0,"%s: line %d: %s",input_grammar_file_path,L,M)
+#define ERROR(M,L) error(BAD_INPUT,0,"%s: line %d: %s",parsing_context->input_grammar_file_path,L,M)
 #define remove_quotes(M) M+=sizeof(char);M[yyleng-2]='\0'
 
-/*WORKING VARIABLES*/
-symbol_list_entry *s=NULL;
-rule_list_entry *r=NULL;
-rule_list_entry *r_list=NULL;
-int r_count = 0;
+/*WORKING VARIABLE*/
+static symbol_list_entry *s=NULL;
 
-/*GLOBAL VARIABLES DEFINED IN CALLING FUNCTION*/
-
-/*POINTER TO SYMBOL TABLE TO BE CONSTRUCTED*/
-extern symbol_list_entry *symbol_table;
-/*ID OF STARTING SYMBOL WILL BE PLACED HERE*/
-extern symbol_id starting_symbol;
-/*NAME OF THE INPUT FILE, FOR ERROR REPORTING PURPOSES*/
-extern char *input_grammar_file_path;
-
-/*GLOBAL STREAM FOR MESSAGES*/
-extern FILE *message_stream;
+/*THE SYMBOL TABLE, THE STARTING SYMBOL AND THE RULES BEING COLLECTED*/
+/*ARE THOSE OF parsing_context, SET BY build_tables()                */
 
 /*STANDARD GLOBAL VARIABLES DEFINED IN FLEX SCANNER*/
 extern char *yytext;
@@ -80,7 +68,7 @@ yfile : 	declarations
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced first PART_SEPARATOR\n");
 			/*INITIALIZE WORKING VARIABLE r*/
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		}
 		grammar
 		{
@@ -145,11 +133,11 @@ start_symbol : 	IDENTIFIER
 		{
 			symbol_list_entry *s = NULL;
 
-			s = get_symbol(symbol_table, $1);
+			s = get_symbol(parsing_context->symbol_table, $1);
 			assert(s != NULL);
 			
 			set_symbol_type(s, NT);
-			starting_symbol = s->id;
+			parsing_context->starting_symbol = s->id;
 		};
 		
 token_declaration :	TOKEN_DECL token_list optional_semicolon
@@ -169,7 +157,7 @@ token:		IDENTIFIER
 
 			assert($1 > 0);	
 
-			s = get_symbol(symbol_table, $1);
+			s = get_symbol(parsing_context->symbol_table, $1);
 			assert(s != NULL);
 
 			if(is_UNDEFINED(s))
@@ -177,7 +165,7 @@ token:		IDENTIFIER
 				/*UNENCOUNTERED DECLARATION*/
 				set_symbol_type(s, LEXICAL);
 			}
-			else if(is_NT(s) && starting_symbol == $1)
+			else if(is_NT(s) && parsing_context->starting_symbol == $1)
 			{
 				/*ATTEMPTING TO DECLARE STARTING SYMBOL AS A TOKEN*/
 				ERROR("token already declared as starting symbol", @1.first_line);
@@ -208,8 +196,8 @@ token:		IDENTIFIER
 			assert($1 > 0);
 			assert($2 > 0);
 
-			s = get_symbol(symbol_table, $1);
-			l = get_symbol(symbol_table, $2);
+			s = get_symbol(parsing_context->symbol_table, $1);
+			l = get_symbol(parsing_context->symbol_table, $2);
 
 			assert(s != NULL);
 			assert(l != NULL);
@@ -219,7 +207,7 @@ token:		IDENTIFIER
 				/*UNENCOUNTERED DECLARATION*/
 				set_symbol_type(s, NT);
 			}
-			else if(is_NT(s) && starting_symbol == $1)
+			else if(is_NT(s) && parsing_context->starting_symbol == $1)
 			{
 				/*ATTEMPTING TO DECLARE STARTING SYMBOL AS A TOKEN*/
 				ERROR("token already declared as starting symbol", @1.first_line);
@@ -275,30 +263,26 @@ grammar : 	grammar definition
 		
 definition :	result ':' rule_list ';'
 		{
-			s = get_symbol(symbol_table, $1);
+			s = get_symbol(parsing_context->symbol_table, $1);
 			assert(s != NULL);
 			
 			if(must_print_message(PARSER))
 				fprintf(message_stream, "reduced rule definition for symbol: %d (%s)\n", s->id, s->name);
 
-			while(r_list != NULL)
-			{	
-				assert(s != NULL);
-
-				insert_rle(s, r_list);
-				r_list = r_list->next;
-			}
+			insert_rle_list(s, parsing_context->r_list);
+			parsing_context->r_list = NULL;
+			parsing_context->r_last = NULL;
 
 			/*MUST SET STARTING SYMBOL IF NOT SET BY %start DECLARATION*/
-			if(starting_symbol == 0)
-				starting_symbol = $1;
+			if(parsing_context->starting_symbol == 0)
+				parsing_context->starting_symbol = $1;
 		};
 
 result : 	IDENTIFIER
 		{
 			symbol_list_entry *s=NULL;
 			
-			s=get_symbol(symbol_table, $1);
+			s=get_symbol(parsing_context->symbol_table, $1);
 			assert(s != NULL);
 
 			/*RESULT OF A RULE MUST BE A NON TERMINAL SYMBOL*/
@@ -315,32 +299,34 @@ rule_list :	rule_list '|' rule
 			/*PUSH THE RULE ON THE LIST AND CREATE A NEW BLANK ONE*/
 			if($3 >= 0)
 			{
-				r_list = link_rle(r_list, r);
+				parsing_context->r_list = link_rle(parsing_context->r_list, parsing_context->r_last, parsing_context->r);
+				parsing_context->r_last = parsing_context->r;
 			}
 			else
 			{	
 				if(must_print_message(PARSER))
 					fprintf(message_stream, "found rule containing 'error' reserved keyword\n");
-				clean_rle_list(r);
+				clean_rle_list(parsing_context->r);
 			}
 
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		}
 		| rule
 		{
 			/*PUSH THE RULE ON THE LIST AND CREATE A NEW BLANK ONE*/
 			if($1 >= 0)
 			{
-				r_list = link_rle(r_list, r);
+				parsing_context->r_list = link_rle(parsing_context->r_list, parsing_context->r_last, parsing_context->r);
+				parsing_context->r_last = parsing_context->r;
 			}
 			else
 			{	
 				if(must_print_message(PARSER))
 					fprintf(message_stream, "found rule containing 'error' reserved keyword\n");
-				clean_rle_list(r);
+				clean_rle_list(parsing_context->r);
 			}
 
-			r = initialize_new_rle();
+			parsing_context->r = initialize_new_rle();
 		};
 		
 rule : 		/*empty*/
@@ -367,7 +353,7 @@ component_list : component_list component
 
 			if($2 > 0)
 			{
-				insert_symbol_rle(r, (symbol_id)$2);
+				insert_symbol_rle(parsing_context->r, (symbol_id)$2);
 			}
 			$$ = $1 * $2;
 			if($$ > 1)
@@ -384,7 +370,7 @@ component_list : component_list component
 
 			if($1 > 0)
 			{
-				insert_symbol_rle(r, (symbol_id)$1);
+				insert_symbol_rle(parsing_context->r, (symbol_id)$1);
 			}
 			$$ = $1;
 			if($$ > 1)
@@ -416,7 +402,7 @@ component :	IDENTIFIER
 
 int yyerror(YYLTYPE *locp, char const *s)
 {
-	fprintf(stderr, "%s: line %d: syntax error: found \"%s\", expecting: \"%s\"\n", input_grammar_file_path, locp->last_line, yytext, s);
+	fprintf(stderr, "%s: line %d: syntax error: found \"%s\", expecting: \"%s\"\n", parsing_context->input_grammar_file_path, locp->last_line, yytext, s);
 	
 	return 1;
 }
@@ -698,14 +698,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define ERROR(M) error(BAD_INPUT,0,"%s: line %d: %s: %s",input_grammar_file_path,yylineno,M,yytext)
 #define remove_quotes(M) M+=sizeof(char);M[yyleng-2]='\0'; yyleng-=2
 
-/*GLOBALS DEFINED IN CALLING FUNCTION*/
+/*FIELDS OF THE CONTEXT WHOSE GRAMMAR IS BEING LOADED (SET BY build_tables())*/
 
 /*NAME OF THE INPUT FILE, FOR ERROR REPORTING PURPOSES*/
-extern char *input_grammar_file_path;
+#define input_grammar_file_path (parsing_context->input_grammar_file_path)
 /*SLE IN WHICH TO INSERT THE SYMBOLS FOUND DURING SCAN*/
-extern symbol_list_entry *symbol_table;
-/*GLOBAL STREAM FOR MESSAGES*/
-extern FILE *message_stream;
+#define symbol_table (parsing_context->symbol_table)
 
 
 /*WORKING VARIABLES*/
@@ -713,9 +711,9 @@ extern FILE *message_stream;
 /*FOR NOT BEING FOOLED BY NESTED BRACKETS*/
 int brack_nesting = 0, prologue = 0;
 
-#line 716 "metagrammar.yylex.c"
+#line 714 "metagrammar.yylex.c"
 
-#line 718 "metagrammar.yylex.c"
+#line 716 "metagrammar.yylex.c"
 
 #define INITIAL 0
 #define in_curly_brackets 1
@@ -943,11 +941,11 @@ YY_DECL
 		}
 
 	{
-#line 73 "metagrammar.lex"
+#line 71 "metagrammar.lex"
 
 
 
-#line 950 "metagrammar.yylex.c"
+#line 948 "metagrammar.yylex.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -1017,7 +1015,7 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 76 "metagrammar.lex"
+#line 74 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found START_DECL");
@@ -1026,7 +1024,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 82 "metagrammar.lex"
+#line 80 "metagrammar.lex"
 {
 				/*THESE BISON DECLARATIONS ARE ALL EQUAL TO */
 				/*THE %token DECLARATION                    */
@@ -1037,7 +1035,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 90 "metagrammar.lex"
+#line 88 "metagrammar.lex"
 {
 				/*THESE DECLARATIONS DON'T MATTER TO FORSON     */
 				/*BUT IDENTIFIERS CAN FOLLOW (MUST BE DISCARDED)*/
@@ -1053,7 +1051,7 @@ YY_LINENO_REWIND_TO(yy_bp + 1);
 (yy_c_buf_p) = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 98 "metagrammar.lex"
+#line 96 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("...exiting start condition");
@@ -1066,14 +1064,14 @@ YY_RULE_SETUP
 case 5:
 /* rule 5 can match eol */
 YY_RULE_SETUP
-#line 107 "metagrammar.lex"
+#line 105 "metagrammar.lex"
 {
 				/*EAT ANYTHING IN MISCELLANEOUS DECLARATIONS*/
 			}
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 111 "metagrammar.lex"
+#line 109 "metagrammar.lex"
 {
 				/*THESE DECLARATIONS DON'T MATTER TO FORSON*/
 				if(must_print_message(G_SCANNER))
@@ -1084,7 +1082,7 @@ YY_RULE_SETUP
 case 7:
 /* rule 7 can match eol */
 YY_RULE_SETUP
-#line 118 "metagrammar.lex"
+#line 116 "metagrammar.lex"
 {
 				/*THESE DECLARATIONS DON'T MATTER BUT SPECIFY A STRING (MUST BE DISCARDED)*/
 				/*REMOVE TRAILING NEWLINE*/
@@ -1097,7 +1095,7 @@ YY_RULE_SETUP
 case 8:
 /* rule 8 can match eol */
 YY_RULE_SETUP
-#line 127 "metagrammar.lex"
+#line 125 "metagrammar.lex"
 {
 				/*MYSTERIOUS UNDOCUMENTED DECLARATION         */
 				/*WHICH APPEARS IN RULES!!!                   */
@@ -1108,7 +1106,7 @@ YY_RULE_SETUP
 case 9:
 /* rule 9 can match eol */
 YY_RULE_SETUP
-#line 134 "metagrammar.lex"
+#line 132 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found PART_SEPARATOR");
@@ -1117,7 +1115,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 140 "metagrammar.lex"
+#line 138 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found ERROR_RESERVED_TOKEN");
@@ -1129,7 +1127,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 149 "metagrammar.lex"
+#line 147 "metagrammar.lex"
 {
 				symbol_list_entry *s = NULL;
 
@@ -1137,16 +1135,13 @@ YY_RULE_SETUP
 					MESSAGE_WITH("found IDENTIFIER");
 
 				/*ADD THE NEW IDENTIFIER IF MISSING. SET SEMANTIC VALUES*/
-				s = get_symbol_by_name(symbol_table, yytext);
+				/*LITERALS WITH THE SAME TEXT ARE NOT CONSIDERED          */
+				s = get_symbol_by_name_and_kind(symbol_table, yytext, 0);
 					
 				if(s == NULL)
 				{
 					yylval = (int) insert_symbol(symbol_table, yytext, UNDEFINED);
 				}
-				else if(is_LITERAL(s) == 1)
-				{
-					yylval = (int) insert_symbol(symbol_table, yytext, UNDEFINED);
-				}
 				else
 				{
 					yylval = (int) s->id;
@@ -1157,7 +1152,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 174 "metagrammar.lex"
+#line 169 "metagrammar.lex"
 {
 				symbol_list_entry *s = NULL;
 
@@ -1166,15 +1161,11 @@ YY_RULE_SETUP
 
 				remove_quotes(yytext);
 				/*ADD THE NEW LITERAL IF MISSING. SET SEMANTIC VALUE*/
-				s = get_symbol_by_name(symbol_table, yytext);
+				s = get_symbol_by_name_and_kind(symbol_table, yytext, 1);
 				if(s == NULL)
 				{
 					yylval = (int) insert_symbol(symbol_table, yytext, LITERAL);
 				}
-				else if(is_LITERAL(s) == 0)
-				{
-					yylval = (int) insert_symbol(symbol_table, yytext, LITERAL);
-				}
 				else
 				{
 					yylval = (int) s->id;
@@ -1185,7 +1176,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 199 "metagrammar.lex"
+#line 190 "metagrammar.lex"
 {
 				symbol_list_entry *s = NULL;
 
@@ -1195,15 +1186,11 @@ YY_RULE_SETUP
 				remove_quotes(yytext);	
 
 				/*ADD THE NEW LITERAL IF MISSING. SET SEMANTIC VALUE*/
-				s = get_symbol_by_name(symbol_table, yytext);
+				s = get_symbol_by_name_and_kind(symbol_table, yytext, 1);
 				if(s == NULL)
 				{
 					yylval = (int) insert_symbol(symbol_table, yytext, LITERAL);
 				}
-				else if(is_LITERAL(s) == 0)
-				{
-					yylval = (int) insert_symbol(symbol_table, yytext, LITERAL);
-				}
 				else
 				{
 					yylval = (int) s->id;
@@ -1214,7 +1201,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 225 "metagrammar.lex"
+#line 212 "metagrammar.lex"
 {
 				/*EAT SEMANTIC VALUE TYPE IDENTIFIERS (FOUND IN TOKEN DECLARATIONS)*/
 				if(must_print_message(G_SCANNER))
@@ -1223,7 +1210,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 231 "metagrammar.lex"
+#line 218 "metagrammar.lex"
 {
 				/*EAT DECIMAL AND HEX NUMBERS*/
 				if(must_print_message(G_SCANNER))
@@ -1232,7 +1219,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 237 "metagrammar.lex"
+#line 224 "metagrammar.lex"
 {
 				/*EAT DECIMAL AND HEX NUMBERS*/
 				if(must_print_message(G_SCANNER))
@@ -1241,7 +1228,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 243 "metagrammar.lex"
+#line 230 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found SEMICOLON");
@@ -1250,7 +1237,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 249 "metagrammar.lex"
+#line 236 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found COLON");
@@ -1259,7 +1246,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 255 "metagrammar.lex"
+#line 242 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("found VERTICAL_BAR");
@@ -1268,7 +1255,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 261 "metagrammar.lex"
+#line 248 "metagrammar.lex"
 {
 				brack_nesting++;
 				if(must_print_message(G_SCANNER))
@@ -1278,17 +1265,17 @@ YY_RULE_SETUP
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 268 "metagrammar.lex"
+#line 255 "metagrammar.lex"
 /*JUST EAT THIS TO AVOID TO CONSIDER QUOTED BRACKETS*/
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 270 "metagrammar.lex"
+#line 257 "metagrammar.lex"
 /*JUST EAT THIS TO AVOID TO CONSIDER QUOTED BRACKETS*/
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 272 "metagrammar.lex"
+#line 259 "metagrammar.lex"
 {
 				/*TO AVOID CONSIDERING BRACKETS IN COMMENTS*/
 				if(must_print_message(G_SCANNER))
@@ -1298,7 +1285,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 278 "metagrammar.lex"
+#line 265 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT(yytext);
@@ -1309,13 +1296,13 @@ YY_RULE_SETUP
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 286 "metagrammar.lex"
+#line 273 "metagrammar.lex"
 {
 				brack_nesting++;
 			}
 	YY_BREAK
 case YY_STATE_EOF(in_curly_brackets):
-#line 289 "metagrammar.lex"
+#line 276 "metagrammar.lex"
 {
 				strcpy(yytext, "EOF");
 				ERROR("expecting }, found");
@@ -1323,7 +1310,7 @@ case YY_STATE_EOF(in_curly_brackets):
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 293 "metagrammar.lex"
+#line 280 "metagrammar.lex"
 {
 				brack_nesting--;			
 				if(brack_nesting == 0)
@@ -1336,7 +1323,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 303 "metagrammar.lex"
+#line 290 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("in INLINE COMMENT...");
@@ -1346,7 +1333,7 @@ YY_RULE_SETUP
 case 28:
 /* rule 28 can match eol */
 YY_RULE_SETUP
-#line 308 "metagrammar.lex"
+#line 295 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("out OF INLINE COMMENT");
@@ -1355,12 +1342,12 @@ YY_RULE_SETUP
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 313 "metagrammar.lex"
+#line 300 "metagrammar.lex"
 /*EAT EVERYTHING ELSE*/
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 315 "metagrammar.lex"
+#line 302 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("entering COMMENT...");
@@ -1370,11 +1357,11 @@ YY_RULE_SETUP
 case 31:
 /* rule 31 can match eol */
 YY_RULE_SETUP
-#line 321 "metagrammar.lex"
+#line 308 "metagrammar.lex"
 /*EAT ANYTHING IN COMMENT EXCEPT '*' */
 	YY_BREAK
 case YY_STATE_EOF(in_comment):
-#line 323 "metagrammar.lex"
+#line 310 "metagrammar.lex"
 {
 				strcpy(yytext, "EOF");
 				ERROR("expecting */, found");
@@ -1382,7 +1369,7 @@ case YY_STATE_EOF(in_comment):
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 328 "metagrammar.lex"
+#line 315 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("exiting COMMENT...");
@@ -1392,7 +1379,7 @@ YY_RULE_SETUP
 case 33:
 /* rule 33 can match eol */
 YY_RULE_SETUP
-#line 334 "metagrammar.lex"
+#line 321 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("back in COMMENT...");
@@ -1401,14 +1388,14 @@ YY_RULE_SETUP
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 340 "metagrammar.lex"
+#line 327 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("exiting COMMENT...");
 			}
 	YY_BREAK
 case YY_STATE_EOF(exiting_comment):
-#line 345 "metagrammar.lex"
+#line 332 "metagrammar.lex"
 {
 				strcpy(yytext, "EOF");
 				yyleng = 4;
@@ -1417,7 +1404,7 @@ case YY_STATE_EOF(exiting_comment):
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 351 "metagrammar.lex"
+#line 338 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("out of COMMENT");
@@ -1439,7 +1426,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 370 "metagrammar.lex"
+#line 357 "metagrammar.lex"
 {
 				prologue++;
 				if(must_print_message(G_SCANNER))
@@ -1449,7 +1436,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 377 "metagrammar.lex"
+#line 364 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("entering COMMENT in PROLOGUE...");
@@ -1459,12 +1446,12 @@ YY_RULE_SETUP
 case 38:
 /* rule 38 can match eol */
 YY_RULE_SETUP
-#line 382 "metagrammar.lex"
+#line 369 "metagrammar.lex"
 /*EAT ANYTHING IN PROLOGUE EXCEPT '%' */	
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 384 "metagrammar.lex"
+#line 371 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("exiting PROLOGUE...");
@@ -1474,7 +1461,7 @@ YY_RULE_SETUP
 case 40:
 /* rule 40 can match eol */
 YY_RULE_SETUP
-#line 390 "metagrammar.lex"
+#line 377 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("back in PROLOGUE...");
@@ -1483,7 +1470,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 395 "metagrammar.lex"
+#line 382 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("entering COMMENT in PROLOGUE...");
@@ -1492,7 +1479,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 400 "metagrammar.lex"
+#line 387 "metagrammar.lex"
 {
 				if(must_print_message(G_SCANNER))
 					MESSAGE_WITHOUT("out of PROLOGUE");
@@ -1501,7 +1488,7 @@ YY_RULE_SETUP
 			}
 	YY_BREAK
 case YY_STATE_EOF(exiting_prologue):
-#line 406 "metagrammar.lex"
+#line 393 "metagrammar.lex"
 {
 				strcpy(yytext, "EOF");
 				yyleng = 4;
@@ -1511,13 +1498,13 @@ case YY_STATE_EOF(exiting_prologue):
 case 43:
 /* rule 43 can match eol */
 YY_RULE_SETUP
-#line 412 "metagrammar.lex"
+#line 399 "metagrammar.lex"
 /*EAT WHITESPACE*/
 	YY_BREAK
 case 44:
 /* rule 44 can match eol */
 YY_RULE_SETUP
-#line 414 "metagrammar.lex"
+#line 401 "metagrammar.lex"
 {
 				strcpy(yytext, "new line");
 				ERROR("expecting \", found");
@@ -1526,7 +1513,7 @@ YY_RULE_SETUP
 case 45:
 /* rule 45 can match eol */
 YY_RULE_SETUP
-#line 418 "metagrammar.lex"
+#line 405 "metagrammar.lex"
 {
 				strcpy(yytext, "tab or newline");
 				ERROR("expecting character, found");
@@ -1535,28 +1522,28 @@ YY_RULE_SETUP
 case 46:
 /* rule 46 can match eol */
 YY_RULE_SETUP
-#line 423 "metagrammar.lex"
+#line 410 "metagrammar.lex"
 {
 				ERROR("found multi-character character literal");
 			}
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 427 "metagrammar.lex"
+#line 414 "metagrammar.lex"
 {
 				ERROR("found empty string literal");
 			}
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 431 "metagrammar.lex"
+#line 418 "metagrammar.lex"
 {
 				ERROR("found empty character literal");
 			}
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 435 "metagrammar.lex"
+#line 422 "metagrammar.lex"
 {
 				ERROR("unrecognized character");
 			}
@@ -1566,7 +1553,7 @@ case YY_STATE_EOF(in_double_quotes):
 case YY_STATE_EOF(in_prologue):
 case YY_STATE_EOF(in_inline_comment):
 case YY_STATE_EOF(in_misc_decl):
-#line 439 "metagrammar.lex"
+#line 426 "metagrammar.lex"
 {
 				strcpy(yytext, "EOF");
 				if(must_print_message(G_SCANNER))
@@ -1576,10 +1563,10 @@ case YY_STATE_EOF(in_misc_decl):
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 446 "metagrammar.lex"
+#line 433 "metagrammar.lex"
 ECHO;
 	YY_BREAK
-#line 1582 "metagrammar.yylex.c"
+#line 1569 "metagrammar.yylex.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -2596,6 +2583,6 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 446 "metagrammar.lex"
+#line 433 "metagrammar.lex"
 
 
@@ -0,0 +1,101 @@
+/*
+output.c -- buffered output of generator states
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+
+/*THE TEXT OF THE SENTENCES IS COLLECTED IN THE BUFFER OF THE GENERATOR*/
+/*STATE AND WRITTEN ON IT'S OUTPUT STREAM WITH A SINGLE fwrite() WHEN  */
+/*THE BUFFER IS FULL, OR WHEN flush_output() IS CALLED. ANYTHING ELSE  */
+/*WRITTEN ON THE SAME STREAM MUST BE PRECEDED BY A flush_output()      */
+
+
+/*WRITES length BYTES FROM bytes ON THE OUTPUT OF gs*/
+void
+write_output(generation_state *gs, const char *bytes, size_t length)
+{
+	assert(gs != NULL);
+	assert(bytes != NULL || length == 0);
+
+	if(gs->buffer_used + length > gs->buffer_size)
+	{
+		flush_output(gs);
+
+		/*LARGE WRITES SKIP THE BUFFER*/
+		if(length >= gs->buffer_size)
+		{
+			if(fwrite(bytes, sizeof(char), length, gs->output) != length)
+				error(UNEXPECTED_ERROR, errno, "%s", "could not write the output");
+			return;
+		}
+	}
+
+	memcpy(gs->buffer + gs->buffer_used, bytes, length);
+	gs->buffer_used += length;
+}
+
+
+/*RETURNS A POINTER TO AT LEAST length FREE BYTES AT THE END OF THE BUFFER*/
+/*OF gs. THE BYTES ACTUALLY FILLED IN MUST BE DECLARED BY commit_output() */
+char *
+reserve_output(generation_state *gs, size_t length)
+{
+	assert(gs != NULL);
+
+	if(gs->buffer_used + length > gs->buffer_size)
+	{
+		flush_output(gs);
+
+		/*THE BUFFER IS EMPTY NOW, SO IT CAN BE REPLACED BY A LARGER ONE*/
+		if(length > gs->buffer_size)
+		{
+			free(gs->buffer);
+			gs->buffer = xmalloc(length);
+			gs->buffer_size = length;
+		}
+	}
+
+	return gs->buffer + gs->buffer_used;
+}
+
+
+/*ADDS TO THE OUTPUT THE FIRST length BYTES RETURNED BY reserve_output()*/
+void
+commit_output(generation_state *gs, size_t length)
+{
+	assert(gs != NULL);
+	assert(gs->buffer_used + length <= gs->buffer_size);
+
+	gs->buffer_used += length;
+}
+
+
+/*WRITES THE CONTENT OF THE BUFFER OF gs ON IT'S OUTPUT STREAM*/
+void
+flush_output(generation_state *gs)
+{
+	assert(gs != NULL);
+
+	if(gs->buffer_used == 0)
+		return;
+
+	if(fwrite(gs->buffer, sizeof(char), gs->buffer_used, gs->output) != gs->buffer_used)
+		error(UNEXPECTED_ERROR, errno, "%s", "could not write the output");
+	gs->buffer_used = 0;
+}
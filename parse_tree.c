@@ -1,44 +1,38 @@
 #include <generation.h>
 
-tree_node *init_tree_node(symbol_id sym){
-    tree_node *ret = xmalloc(sizeof(tree_node));
+tree_node *init_tree_node(arena *a, symbol_id sym){
+    // nodes live in the tree arena; the children array is allocated on the first push
+    tree_node *ret = arena_alloc(a, sizeof(tree_node));
     assert(ret != NULL);
 
-    ret->children = xcalloc(PARSE_TREE_DEFAULT_CHILDREN_NUM, sizeof(tree_node *));
-    assert(ret->children != NULL);
-
+    ret->children = NULL;
     ret->sym = sym;
-    ret->children_array_size = PARSE_TREE_DEFAULT_CHILDREN_NUM;
+    ret->children_array_size = 0;
     ret->num_children = 0;
     ret->parent=NULL;
     ret->expanded=0;
     return ret;
 }
 
-tree_node *init_empty_tree_node(void){
-    tree_node *ret = xmalloc(sizeof(tree_node));
-    assert(ret != NULL);
-
-    ret->children = xcalloc(PARSE_TREE_DEFAULT_CHILDREN_NUM, sizeof(tree_node *));
-    assert(ret->children != NULL);
-
-    ret->sym = 0;
-    ret->children_array_size = PARSE_TREE_DEFAULT_CHILDREN_NUM;
-    ret->num_children = 0;
-    ret->parent=NULL;
-    ret->expanded=0;
-    return ret;
+tree_node *init_empty_tree_node(arena *a){
+    return init_tree_node(a, 0);
 }
 
-int tree_node_push_child(tree_node *parent, symbol_id sym){
+int tree_node_push_child(parse_tree *tree, tree_node *parent, symbol_id sym){
     // create the child node
+    assert(tree != NULL);
     assert(parent != NULL);
-    tree_node* child = init_tree_node(sym);
+    tree_node* child = init_tree_node(tree->nodes, sym);
     child->parent=parent;
     if(parent->num_children >= parent->children_array_size){
-        // need to resize the array
-        parent->children = realloc(parent->children, parent->children_array_size * 2 * sizeof(tree_node *));
-        parent->children_array_size *= 2;
+        // need to resize the array: take a bigger one from the arena, the old one is dropped with it
+        int new_size = (parent->children_array_size == 0) ? PARSE_TREE_DEFAULT_CHILDREN_NUM : parent->children_array_size * 2;
+        tree_node **children = arena_alloc(tree->nodes, new_size * sizeof(tree_node *));
+        if(parent->num_children > 0){
+            memcpy(children, parent->children, parent->num_children * sizeof(tree_node *));
+        }
+        parent->children = children;
+        parent->children_array_size = new_size;
     }
 
     assert(parent->children != NULL);
@@ -53,32 +47,38 @@ int tree_node_push_child(tree_node *parent, symbol_id sym){
 }
 
 /**
- * @brief Must be called only on the root of the parse tree
- * 
- * @param node 
+ * @brief Sizes the children array of a node for n children at once,
+ * avoiding regrowth when a whole rule is pushed
  */
-
-void tree_node_clean(tree_node *node){
-    int i;
+void tree_node_reserve_children(parse_tree *tree, tree_node *node, int n){
+    assert(tree != NULL);
     assert(node != NULL);
-    //assert(node->parent==NULL);
-    for(i = 0; i < node->num_children; i++){
-        // recursively clean all the subtrees
-        tree_node_clean(node->children[i]);
+    if(node->num_children == 0 && n > node->children_array_size){
+        node->children = arena_alloc(tree->nodes, n * sizeof(tree_node *));
+        node->children_array_size = n;
     }
-    free(node->children);
-    free(node);
 }
 
 parse_tree * init_parse_tree(symbol_id sym){
     parse_tree* tree = xmalloc(sizeof(parse_tree));
     assert(tree!=NULL);
-    tree->root=init_tree_node(sym);
+    tree->nodes = initialize_new_arena(PARSE_TREE_ARENA_CHUNK_SIZE);
+    tree->root=init_tree_node(tree->nodes, sym);
     return tree;
 }
 
+/**
+ * @brief Drops all the nodes of the tree with a single arena reset
+ * and starts a new tree rooted in sym, reusing the arena memory
+ */
+void parse_tree_reset(parse_tree *tree, symbol_id sym){
+    assert(tree != NULL);
+    reset_arena(tree->nodes);
+    tree->root=init_tree_node(tree->nodes, sym);
+}
+
 void parse_tree_clean(parse_tree *tree){
-    tree_node_clean(tree->root);
+    clean_arena(tree->nodes);
     free(tree);
 }
 
@@ -99,7 +99,7 @@ int calculate_subtree_depth(tree_node* node) {
     return max_depth + 1;
 }
 
-void stampa_sottoalbero(tree_node* nodo, int livello, int ultimo_ramo[], symbol_list_entry * sym_tab) {
+void stampa_sottoalbero(FILE *f, tree_node* nodo, int livello, int ultimo_ramo[], symbol_list_entry * sym_tab) {
     if (nodo == NULL) {
         return;
     }
@@ -107,33 +107,81 @@ void stampa_sottoalbero(tree_node* nodo, int livello, int ultimo_ramo[], symbol_
     // Stampa l'indentazione in base al livello del nodo
     for (int i = 0; i < livello; i++) {
         if (ultimo_ramo[i] == 0) {
-            printf("│  ");
+            fprintf(f, "│  ");
         } else {
-            printf("   ");
+            fprintf(f, "   ");
         }
     }
     
     if (livello > 0) {
-        printf("├─");
+        fprintf(f, "├─");
     }
     
-    printf(" %s\n", get_symbol(sym_tab,nodo->sym)->name);  // Stampa il valore sym del nodo
+    fprintf(f, " %s\n", get_symbol(sym_tab,nodo->sym)->name);  // Stampa il valore sym del nodo
     
     int num_figli = nodo->num_children;
     
     for (int i = 0; i < num_figli; i++) {
         ultimo_ramo[livello] = (i == num_figli - 1) ? 1 : 0;
-        stampa_sottoalbero(nodo->children[i], livello + 1, ultimo_ramo,sym_tab);
+        stampa_sottoalbero(f, nodo->children[i], livello + 1, ultimo_ramo,sym_tab);
     }
 }
 
 
-void print_tree(tree_node *root, symbol_list_entry* sym_tab){
+void print_tree(FILE *f, tree_node *root, symbol_list_entry* sym_tab){
     size_t depth = calculate_subtree_depth(root);
     int ultimo_ramo[depth];
     int i;
     for(i=0;i<depth;i++){
         ultimo_ramo[i]=0;
     }
-    stampa_sottoalbero(root,0,ultimo_ramo,sym_tab);
-}
\ No newline at end of file
+    stampa_sottoalbero(f,root,0,ultimo_ramo,sym_tab);
+}
+
+static void print_compact_name(FILE *f, symbol_list_entry *sle){
+    const char *c;
+    if(!is_LITERAL(sle)){
+        fputs(sle->name, f);
+        return;
+    }
+    // literal names keep their C escapes; only bare double quotes need escaping
+    fputc('"', f);
+    for(c = sle->name; *c != '\0'; c++){
+        if(*c == '\\' && c[1] != '\0'){
+            fputc(*c++, f);
+        }
+        else if(*c == '"'){
+            fputc('\\', f);
+        }
+        fputc(*c, f);
+    }
+    fputc('"', f);
+}
+
+static void print_compact_subtree(FILE *f, tree_node *node, symbol_list_entry *sym_tab){
+    symbol_list_entry *sle = get_symbol(sym_tab, node->sym);
+    int i;
+    assert(sle != NULL);
+    if(!is_NT(sle)){
+        print_compact_name(f, sle);
+        return;
+    }
+    fputc('(', f);
+    print_compact_name(f, sle);
+    for(i = 0; i < node->num_children; i++){
+        fputc(' ', f);
+        print_compact_subtree(f, node->children[i], sym_tab);
+    }
+    fputc(')', f);
+}
+
+/**
+ * @brief Prints the tree on a single line as an S-expression:
+ * non-terminals as (name children...), tokens by name, literals double quoted
+ */
+void print_tree_compact(FILE *f, tree_node *root, symbol_list_entry* sym_tab){
+    assert(f != NULL);
+    assert(root != NULL);
+    print_compact_subtree(f, root, sym_tab);
+    fputc('\n', f);
+}
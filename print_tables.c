@@ -21,17 +21,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <generation.h>
 
-extern FILE *message_stream, *output_stream;
-extern symbol_list_entry *symbol_table;
 extern int rc_values[];
-extern symbol_id starting_symbol;
-extern int verbosity;
 extern char *rule_type_names[];
 
 
 /*CYCLE THROUGH ALL SYMBOLS IN TABLE l AND PRINT THE CORRECT DESCRIPTIVE INFORMATION*/
 void
-print_symbol_list(symbol_list_entry *l)
+print_symbol_list(symbol_list_entry *l, symbol_id starting_symbol)
 {
 	int i=0, symbol_count=0, old_verbosity=0;
 	symbol_list_entry *sle=NULL;	
@@ -90,7 +86,7 @@ print_symbol_list(symbol_list_entry *l)
 		/*IN CASE OF NON-TERMINALS, PRINT TRAILING RULE LIST TABLE*/
 		if(is_NT(sle))
 		{
-			print_rule_list(sle);
+			print_rule_list(sle, l);
 		}
 	}
 
@@ -102,7 +98,7 @@ print_symbol_list(symbol_list_entry *l)
 
 /*PRINT ALL RULES OF A SINGLE NON-TERMINAL SYMBOL*/
 void
-print_rule_list(symbol_list_entry *l)
+print_rule_list(symbol_list_entry *l, symbol_list_entry *symbol_table)
 {
 	int i;
 	float f = 0.0, f_old = 0.0;
@@ -165,6 +161,41 @@ print_rule_list(symbol_list_entry *l)
 	}
 }
 
+/*PRINTS length BYTES FROM bytes ON f, WRITING NON PRINTABLE CHARACTERS,*/
+/*BACKSLASHES AND DOUBLE QUOTES AS C ESCAPE SEQUENCES                   */
+void
+print_escaped_bytes(FILE *f, char *bytes, size_t length)
+{
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		unsigned char c = (unsigned char) bytes[i];
+
+		switch(c)
+		{
+			case '\\':
+				fputs("\\\\", f);
+				break;
+			case '"':
+				fputs("\\\"", f);
+				break;
+			case '\n':
+				fputs("\\n", f);
+				break;
+			case '\t':
+				fputs("\\t", f);
+				break;
+			default:
+				if(isprint(c))
+					fputc(c, f);
+				else
+					fprintf(f, "\\%03o", c);
+		}
+	}
+}
+
+
 /*PRINTS THE LEXICON STRUCTURE CONTENTS FOR A SINGLE TERMINAL SYMBOL*/
 void
 print_lexicon_table(symbol_list_entry *l)
@@ -188,23 +219,28 @@ print_lexicon_table(symbol_list_entry *l)
 
 			if(get_lexicon_numerosity(current_symbol) != 0)
 			{
-				lexicon_argz_structure *lazs = NULL;
+				lexicon_structure *lex = NULL;
 				int index = 0, numerosity = 0;
-				char *position = NULL;
 
-				lazs = (lexicon_argz_structure *) current_symbol->rules;
-				assert(lazs != NULL);
+				lex = (lexicon_structure *) current_symbol->rules;
+				assert(lex != NULL);
 
 				numerosity = get_lexicon_numerosity(current_symbol);
 				assert(numerosity > 0);
 
 				while(index < numerosity)
 				{
-					position = argz_next(lazs->argz, lazs->argz_size, position);
-					assert(position != NULL);
+					char *unit;
+					size_t length;
+
+					unit = get_lexicon_unit(lex, index, &length);
 
 					fprintf(TABLE_STREAM, "%d:", index+1);
-					fprintf(TABLE_STREAM, "\t%s\n", position);
+					fprintf(TABLE_STREAM, "\t");
+					print_escaped_bytes(TABLE_STREAM, unit, length);
+					if(lex->unit_weight != NULL)
+						fprintf(TABLE_STREAM, "\t(weight %u)", lex->unit_weight[index]);
+					fprintf(TABLE_STREAM, "\n");
 
 					index++;
 				}
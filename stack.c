@@ -21,13 +21,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <generation.h>
 
 /*ALLOCATES MEMORY FOR A STACK STRUCTURE, WIPES IT TO ZERO AND RETURNS A POINTER*/
+/*SYMBOLS ARE STORED BY VALUE IN A CONTIGUOUS BUFFER, DOUBLED WHEN FULL         */
 stack *
 initialize_new_stack()
 {
 	stack *new_stack = NULL;
 
 	new_stack = xcalloc(1, sizeof(stack));
-	new_stack->buffer = xcalloc(STACK_DEFAULT_SIZE, sizeof(symbol_id *));
+	new_stack->buffer = xcalloc(STACK_DEFAULT_SIZE, sizeof(symbol_id));
 	new_stack->stack_size = STACK_DEFAULT_SIZE;
 
 	return new_stack;
@@ -38,9 +39,6 @@ initialize_new_stack()
 symbol_id
 pop(stack *st)
 {
-	int fragment, offset;
-	symbol_id *buf = NULL;
-
 	assert(st != NULL);
 
 	if(st->size == 0)
@@ -48,13 +46,7 @@ pop(stack *st)
 		return 0;
 	}
 
-	st->size--;
-
-	buf = st->buffer[st->size];
-
-	int ret = *buf;
-	free(buf);
-	return ret;
+	return st->buffer[--(st->size)];
 }
 
 
@@ -62,23 +54,19 @@ pop(stack *st)
 int
 push(stack *st, symbol_id symb)
 {
-	int fragment, offset;
-	symbol_id *buf = NULL;
-
 	assert(st != NULL);
 	assert(symb != (symbol_id) 0);
 
-	st->size++;
-	if(st->size - 1 >= st->stack_size){
-		// double the size
-		st->buffer = realloc(st->buffer, sizeof(symbol_id *) * st->stack_size * 2);
+	if(st->size >= st->stack_size)
+	{
+		/*DOUBLE THE SIZE*/
+		st->buffer = realloc(st->buffer, sizeof(symbol_id) * st->stack_size * 2);
+		if(st->buffer == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
 		st->stack_size *= 2;
 	}
-	
-	st->buffer[st->size - 1] = xcalloc(1, sizeof(symbol_id));
-	buf = st->buffer[st->size - 1];
-	*buf = symb;
-	
+
+	st->buffer[st->size++] = symb;
 
 	return st->size;
 }
@@ -93,15 +81,22 @@ int get_size(stack *st)
 }
 
 
+/*EMPTIES THE STACK, KEEPING ITS BUFFER FOR REUSE (E.G. ACROSS SENTENCES)*/
+void reset_stack(stack *st)
+{
+	assert(st != NULL);
+
+	st->size = 0;
+}
+
+
 /*FREES MEMORY USED BY A STACK STRUCTURE*/
 int clean_stack(stack *st)
 {
 	assert(st != NULL);
 
-	for (int i = 0; i < st->size; i++){
-		free(st->buffer[i]);
-	}
 	free(st->buffer);
 	free(st);
-}
 
+	return 0;
+}
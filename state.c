@@ -0,0 +1,315 @@
+/*
+state.c -- coverage state files
+Copyright 2005 Alfonso Tarantini
+This file is part of Forson.
+
+Forson is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+Forson is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Forson; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <generation.h>
+#include <inttypes.h>
+
+/*A COVERAGE STATE FILE LISTS WHAT HAS BEEN COVERED BY THE SENTENCES    */
+/*GENERATED SO FAR, SO THAT AFTER A CHANGE OF THE GRAMMAR ONLY THE NEW  */
+/*OR CHANGED RULES NEED NEW SENTENCES. IT IS A TEXT FILE: A LINE WITH   */
+/*COVERAGE_STATE_MAGIC AND THE VERSION, THEN A LINE "r KEY" FOR EVERY   */
+/*RULE COVERED AND (WITH PAIR COVERAGE) "p KEY" FOR EVERY PAIR COVERED. */
+/*KEYS ARE 64 BIT FNV-1a HASHES, IN HEXADECIMAL, OF THE CONTENT OF THE  */
+/*RULES: THE NAMES AND KINDS OF IT'S SYMBOLS. THEY DO NOT DEPEND ON THE */
+/*ORDER OF THE RULES, NOR ON THE OTHER RULES OF THE GRAMMAR. A RUN WITH */
+/*RULE COVERAGE KEEPS THE PAIRS OF THE FILE AS THEY ARE                 */
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/*KEYS READ FROM A STATE FILE, SORTED*/
+typedef struct COVERAGE_KEYS
+{
+	uint64_t *keys;
+	int count;
+	int size;
+} coverage_keys;
+
+
+/*ADDS length BYTES FROM bytes TO THE FNV-1a HASH h*/
+static uint64_t
+hash_bytes(uint64_t h, const void *bytes, size_t length)
+{
+	const unsigned char *b = bytes;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		h ^= b[i];
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+
+
+/*ADDS THE KIND AND THE NAME OF sle TO THE HASH h*/
+static uint64_t
+hash_symbol_name(uint64_t h, symbol_list_entry *sle)
+{
+	char kind = is_NT(sle)? 'n' : (is_LITERAL(sle)? 'l' : 't');
+
+	h = hash_bytes(h, &kind, 1);
+	return hash_bytes(h, sle->name, strlen(sle->name) + 1);
+}
+
+
+/*RETURNS THE KEYS OF ALL THE RULES OF THE GRAMMAR, AND AT rule_count */
+/*THE KEY OF THE PARENT OF THE STARTING SYMBOL (SEE build_pair_table())*/
+static uint64_t *
+hash_grammar_rules(generator_context *ctx)
+{
+	symbol_list_entry *symbol_table = ctx->symbol_table;
+	grammar_image *image = symbol_table->index->image;
+	uint64_t *hashes = NULL;
+	int r, j;
+
+	hashes = xmalloc((image->rule_count + 1) * sizeof(uint64_t));
+	for(r = 0; r < image->rule_count; r++)
+	{
+		rule_list_entry *rle = &(image->rules[r]);
+		uint64_t h = FNV_OFFSET_BASIS;
+
+		h = hash_symbol_name(h, get_symbol(symbol_table, image->rule_lhs[r]));
+		for(j = 0; j < rle->length; j++)
+		{
+			h = hash_symbol_name(h, get_symbol(symbol_table, rle->rhs[j]));
+		}
+		hashes[r] = h;
+	}
+	hashes[image->rule_count] = hash_bytes(FNV_OFFSET_BASIS, "", 1);
+
+	return hashes;
+}
+
+
+/*RETURNS THE KEY OF THE PAIR OF THE RULES WITH KEYS parent AND child, */
+/*THE SECOND ONE EXPANDING THE SYMBOL IN POSITION offset OF THE FIRST  */
+static uint64_t
+hash_rule_pair(uint64_t parent, int offset, uint64_t child)
+{
+	int32_t o = offset;
+	uint64_t h = parent;
+
+	h = hash_bytes(h, &o, sizeof(int32_t));
+	return hash_bytes(h, &child, sizeof(uint64_t));
+}
+
+
+/*COMPARES TWO KEYS FOR qsort() AND bsearch()*/
+static int
+compare_keys(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a;
+	uint64_t y = *(const uint64_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+
+/*APPENDS key TO k*/
+static void
+add_key(coverage_keys *k, uint64_t key)
+{
+	if(k->count == k->size)
+	{
+		k->size = (k->size == 0)? COVERAGE_RECORD_DEFAULT_SIZE : 2 * k->size;
+		k->keys = realloc(k->keys, k->size * sizeof(uint64_t));
+		if(k->keys == NULL)
+			error(UNEXPECTED_ERROR, 0, "%s", "unexpected error: out of memory");
+	}
+	k->keys[k->count++] = key;
+}
+
+
+/*TELLS IF key IS AMONG THE SORTED KEYS OF k*/
+static int
+has_key(coverage_keys *k, uint64_t key)
+{
+	if(k->count == 0)
+		return 0;
+	return bsearch(&key, k->keys, k->count, sizeof(uint64_t), compare_keys) != NULL;
+}
+
+
+/*MARKS AS COVERED IN THE COVERAGE TABLE OF ctx THE RULES (AND, WITH PAIR*/
+/*COVERAGE, THE PAIRS) LISTED IN THE COVERAGE STATE FILE path. ONLY THOSE*/
+/*WHICH CAN BE COVERED IN THE GRAMMAR ARE TAKEN: THE OTHERS HAVE BEEN    */
+/*CHANGED OR REMOVED. A MISSING FILE IS AN EMPTY STATE                   */
+void
+load_coverage_state(generator_context *ctx, char *path)
+{
+	FILE *f = NULL;
+	int version, r, k;
+	char magic[sizeof(COVERAGE_STATE_MAGIC)];
+	char kind;
+	uint64_t key, *hashes = NULL;
+	coverage_keys rule_keys = {NULL, 0, 0}, pair_keys = {NULL, 0, 0};
+	coverage_table *ct = NULL;
+	grammar_image *image = NULL;
+
+	assert(ctx != NULL);
+	assert(path != NULL);
+	ct = ctx->coverage;
+	assert(ct != NULL);
+	image = ctx->symbol_table->index->image;
+
+	f = fopen(path, "r");
+	if(f == NULL && errno == ENOENT)
+	{
+		if(must_print_message(MAIN))
+			fprintf(message_stream, "no coverage state in %s, starting from scratch\n", path);
+		return;
+	}
+	if(f == NULL)
+		error(BAD_ARGUMENTS, errno, "%s", path);
+
+	if(fscanf(f, "%8s %d", magic, &version) != 2 || strcmp(magic, COVERAGE_STATE_MAGIC) != 0)
+		error(BAD_INPUT, 0, "%s: not a coverage state file", path);
+	if(version != COVERAGE_STATE_VERSION)
+		error(BAD_INPUT, 0, "%s: coverage state has version %d, version %d expected", path, version, COVERAGE_STATE_VERSION);
+
+	while((k = fscanf(f, " %c %" SCNx64, &kind, &key)) == 2)
+	{
+		if(kind == 'r')
+			add_key(&rule_keys, key);
+		else if(kind == 'p')
+			add_key(&pair_keys, key);
+		else
+			break;
+	}
+	if(k != EOF || ferror(f))
+		error(BAD_INPUT, 0, "%s: malformed coverage state", path);
+	fclose(f);
+
+	if(rule_keys.count > 0)
+		qsort(rule_keys.keys, rule_keys.count, sizeof(uint64_t), compare_keys);
+	if(pair_keys.count > 0)
+		qsort(pair_keys.keys, pair_keys.count, sizeof(uint64_t), compare_keys);
+	hashes = hash_grammar_rules(ctx);
+
+	for(r = 0; r < image->rule_count; r++)
+	{
+		if(ct->derivation_length[image->rule_lhs[r]] == INT_MAX
+			|| image->rule_min_length[r] == INT_MAX
+			|| has_key(&rule_keys, hashes[r]) == 0)
+			continue;
+		mark_covered(ct, image, r, -1);
+	}
+
+	/*EVERY PAIR IS LOOKED UP FROM THE FIRST POSITION OF IT'S SYMBOL IN THE*/
+	/*PARENT RULE, AS IN build_pair_table()                                */
+	for(k = 0; ct->pair_group != NULL && k <= image->rhs_size; k++)
+	{
+		int parent = ct->pair_parent[k], offset, c;
+		symbol_id s;
+
+		if(ct->pair_group[k] != k)
+			continue;
+		if(parent < image->rule_count
+			&& (ct->derivation_length[image->rule_lhs[parent]] == INT_MAX
+				|| image->rule_min_length[parent] == INT_MAX))
+			continue;
+
+		s = (k == image->rhs_size)? ct->starting_symbol : image->rhs[k];
+		offset = (parent == image->rule_count)? 0 : k - (int)(image->rules[parent].rhs - image->rhs);
+		for(c = image->rule_offset[s]; c < image->rule_offset[s] + image->rule_num[s]; c++)
+		{
+			if(image->rule_min_length[c] == INT_MAX
+				|| has_key(&pair_keys, hash_rule_pair(hashes[parent], offset, hashes[c])) == 0)
+				continue;
+			mark_covered(ct, image, c, k);
+		}
+	}
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "coverage state loaded from %s, %d rules and %d rule pairs left to cover\n",
+			path, ct->uncovered, ct->uncovered_pairs);
+
+	/*PAIRS ARE NOT COVERED BY THIS RUN, BUT MAY BE BY THE NEXT ONE*/
+	if(ct->pair_group == NULL)
+	{
+		ct->kept_pair_keys = pair_keys.keys;
+		ct->kept_pair_count = pair_keys.count;
+		pair_keys.keys = NULL;
+	}
+
+	free(hashes);
+	free(rule_keys.keys);
+	free(pair_keys.keys);
+}
+
+
+/*WRITES IN THE COVERAGE STATE FILE path THE RULES (AND, WITH PAIR*/
+/*COVERAGE, THE PAIRS) COVERED IN THE COVERAGE TABLE OF ctx       */
+void
+save_coverage_state(generator_context *ctx, char *path)
+{
+	FILE *f = NULL;
+	int r, k;
+	uint64_t *hashes = NULL;
+	coverage_table *ct = NULL;
+	grammar_image *image = NULL;
+
+	assert(ctx != NULL);
+	assert(path != NULL);
+	ct = ctx->coverage;
+	assert(ct != NULL);
+	image = ctx->symbol_table->index->image;
+
+	if(must_print_message(MAIN))
+		fprintf(message_stream, "saving coverage state in %s...\n", path);
+
+	f = fopen(path, "w");
+	if(f == NULL)
+		error(BAD_ARGUMENTS, errno, "%s", path);
+	hashes = hash_grammar_rules(ctx);
+
+	fprintf(f, "%s %d\n", COVERAGE_STATE_MAGIC, COVERAGE_STATE_VERSION);
+	for(r = 0; r < image->rule_count; r++)
+	{
+		if(BITSET_TEST(ct->covered_rules, r) != 0)
+			fprintf(f, "r %016" PRIx64 "\n", hashes[r]);
+	}
+
+	for(k = 0; k < ct->kept_pair_count; k++)
+	{
+		fprintf(f, "p %016" PRIx64 "\n", ct->kept_pair_keys[k]);
+	}
+	for(k = 0; ct->pair_group != NULL && k <= image->rhs_size; k++)
+	{
+		int parent = ct->pair_parent[k], offset, c;
+		symbol_id s;
+
+		if(ct->pair_group[k] != k)
+			continue;
+
+		s = (k == image->rhs_size)? ct->starting_symbol : image->rhs[k];
+		offset = (parent == image->rule_count)? 0 : k - (int)(image->rules[parent].rhs - image->rhs);
+		for(c = image->rule_offset[s]; c < image->rule_offset[s] + image->rule_num[s]; c++)
+		{
+			if(BITSET_TEST(ct->covered_pairs, ct->pair_base[k] + c - image->rule_offset[s]) != 0)
+				fprintf(f, "p %016" PRIx64 "\n", hash_rule_pair(hashes[parent], offset, hashes[c]));
+		}
+	}
+
+	if(ferror(f) || fclose(f) != 0)
+		error(UNEXPECTED_ERROR, errno, "%s: could not write the coverage state", path);
+	free(hashes);
+}
@@ -0,0 +1,8 @@
+/*THE CHAIN OF UNIT RULES s -> e -> t -> f OF A LAYERED EXPRESSION   */
+/*GRAMMAR: THE BOLTZMANN SAMPLER MUST BE TUNED FOR IT WITH -b (EXIT 0) */
+%%
+s : e ;
+e : e '+' t | t ;
+t : t '*' f | f ;
+f : '(' e ')' | 'i' | 'n' ;
+%%
@@ -0,0 +1,8 @@
+/*FOUR PARSE TREES OF 3 TOKENS: "a b c", "a b d", "a e f" AND "x y z".  */
+/*WITH -L 3 EVERY ONE MUST BE GENERATED A QUARTER OF THE TIMES, THOUGH */
+/*THE TWO RULES OF s LEAD TO THREE TREES AND TO ONE                    */
+%%
+s : 'a' b | c 'z' ;
+b : 'b' 'c' | 'b' 'd' | 'e' 'f' ;
+c : 'x' 'y' ;
+%%
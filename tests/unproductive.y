@@ -0,0 +1,7 @@
+/*s HAS NO RULE DERIVING A FINITE SENTENCE: THE GRAMMAR MUST BE REJECTED*/
+/*WITH "infinite generation derives from symbol "s"" (EXIT CODE 2)      */
+%%
+s: s a b ;
+a: 'x' ;
+b: a 'y' ;
+%%
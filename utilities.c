@@ -23,17 +23,66 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <time.h>
 
 extern char *optarg;
-extern FILE *message_stream;
 extern int verb_policy[NUMBER_OF_SOURCES];
 extern char * source_names[NUMBER_OF_SOURCES];
-extern int verbosity;
 
 
-/*INITIALIZE RANDOM NUMBER GENERATOR*/
-void
-set_random_seed()
+/*INITIALIZE RANDOM NUMBER GENERATOR AND RETURN THE SEED USED, WHICH IS*/
+/*seed OR, IF IT IS NEGATIVE, THE CURRENT TIME. THE SAME SEED IS THE    */
+/*BASE OF ALL THE GENERATOR STATES                                      */
+unsigned long
+set_random_seed(long seed)
 {	
-	srandom(time(NULL));
+	if(seed < 0)
+		seed = (long) time(NULL);
+
+	srandom((unsigned long) seed);
+	return (unsigned long) seed;
+}
+
+
+/*SPLITMIX64 STEP, USED TO SCRAMBLE SEEDS*/
+static uint64_t
+splitmix64(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+
+/*SEEDS THE RANDOM NUMBER GENERATOR OF gs FOR THE sequence-TH SENTENCE */
+/*GENERATED FROM seed. EVERY SENTENCE GETS IT'S OWN SEQUENCE, SO THE    */
+/*OUTPUT DOES NOT DEPEND ON WHICH THREAD GENERATES WHICH SENTENCE       */
+void
+seed_generation_state(generation_state *gs, unsigned long seed, unsigned long sequence)
+{
+	assert(gs != NULL);
+
+	gs->rng = splitmix64(splitmix64((uint64_t) seed) ^ (uint64_t) sequence);
+	/*THE XORSHIFT GENERATOR MUST NOT START FROM ZERO*/
+	if(gs->rng == 0)
+		gs->rng = 0x9E3779B97F4A7C15ULL;
+}
+
+
+/*RETURNS A PSEUDO-RANDOM NUMBER BETWEEN 0 AND 2^31-1, LIKE random(),*/
+/*FROM THE XORSHIFT64* GENERATOR PRIVATE TO gs                       */
+long
+generation_random(generation_state *gs)
+{
+	uint64_t x;
+
+	assert(gs != NULL);
+
+	x = gs->rng;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	gs->rng = x;
+
+	return (long)((x * 0x2545F4914F6CDD1DULL) >> 33);
 }
 
 
@@ -99,6 +148,67 @@ read_number(char *string)
 }
 
 
+/*READS THE ARGUMENT OF THE -t OPTION OR EXITS WITH AN ERROR*/
+tree_mode
+read_tree_mode(char *string)
+{
+	assert(string != NULL);
+
+	if(strcmp(string, "none") == 0)
+		return NO_TREE;
+	else if(strcmp(string, "pretty") == 0)
+		return PRETTY_TREE;
+	else if(strcmp(string, "compact") == 0)
+		return COMPACT_TREE;
+
+	error(BAD_ARGUMENTS, 0, "%s: %s", "tree mode must be one of none, pretty, compact", string);
+	return NO_TREE;
+}
+
+
+/*READS THE COVERAGE CRITERION OF THE -k OPTION*/
+coverage_criterion
+read_coverage_criterion(char *string)
+{
+	assert(string != NULL);
+
+	if(strcmp(string, "rules") == 0)
+		return RULE_COVERAGE;
+	else if(strcmp(string, "pairs") == 0)
+		return PAIR_COVERAGE;
+
+	error(BAD_ARGUMENTS, 0, "%s: %s", "coverage criterion must be one of rules, pairs", string);
+	return RULE_COVERAGE;
+}
+
+
+/*READS A NUMBER OF TOKENS, "N", OR A RANGE OF NUMBERS OF TOKENS, "MIN-MAX"*/
+/*INTO min AND max, OR EXITS WITH AN ERROR                                */
+void
+read_length_range(char *string, int *min, int *max)
+{
+	char *dash = NULL;
+
+	assert(string != NULL);
+	assert(min != NULL);
+	assert(max != NULL);
+
+	dash = strchr(string, '-');
+	if(dash == NULL)
+	{
+		*min = *max = read_number(string);
+		return;
+	}
+
+	*dash = '\0';
+	*min = read_number(string);
+	*max = read_number(dash + 1);
+	*dash = '-';
+	if(*min > *max)
+		error(BAD_ARGUMENTS, 0, "%s: %s", "the shortest length is greater than the longest", string);
+}
+
+
 /*DECIDES IF TO PRINT MESSAGES FROM VARIOUS SOURCES ACCORDING TO A*/
 /*VERBOSITY POLICY.*/
 int
@@ -159,16 +269,42 @@ print_usage()
 		"\n";
 	char * line4 =
 		"Mandatory arguments to long options are mandatory for short options too\n";
+	char * line4a =
+		"-b, --boltzmann N[-M]	random sentences of about N tokens (N to M with -M), drawn by\n";
+	char * line4b =
+		"			a Boltzmann sampler; N alone accepts sizes within 20%% of N\n";
+	char * line4c =
+		"-C, --compile FILE	saves the compiled grammar in FILE, to be given later as GRAMMAR FILE\n";
+	char * line4d =
+		"			a compiled grammar is loaded without parsing, lexicons included\n";
 	char * line5 = 
 		"-c, --coverage		enables the generation of sentences to cover all grammar rules\n";
 	char * line6 = 
 		"			default is random generation\n";
 	char * line7 = 
 		"-h, --help		displays this help message\n";
+	char * line7a =
+		"-j, --jobs N		generates sentences with N threads, default is 1\n";
+	char * line7b =
+		"-k, --criterion WHAT	what the -c option covers: rules, or pairs of a rule and a rule\n";
+	char * line7c =
+		"			of a non-terminal in it; default is rules\n";
+	char * line7d =
+		"-l, --word-list TOKEN:FILE	every line of FILE is a lexical value of TOKEN\n";
+	char * line7e =
+		"			FILE is mapped in memory, not read; may be repeated\n";
+	char * line7f =
+		"-L, --length N[-M]	random sentences of N tokens (N to M with -M), uniformly among all\n";
+	char * line7g =
+		"			their parse trees; every terminal is a token, default is no limit\n";
 	char * line8 =
 		"-m, --message FILE	instructs forson to print messages to FILE\n";
 	char * line9 =
 		"			default is stdout\n";
+	char * line9a =
+		"-M, --minimize		with -c, writes only a subset of the coverage sentences which\n";
+	char * line9b =
+		"			uses the same rules, dropping the redundant sentences\n";
 	char * line10 =
 		"-n, --no-spaces         instructs forson to not generate blank text in sentences\n";
 	char * line11 =
@@ -185,12 +321,22 @@ print_usage()
 		"			default is 1\n";
 	char * line17=
 		"			ignored if the -c option is set\n";
+	char * line17a=
+		"-R, --seed N		seeds the random generator with N, default is the current time\n";
 	char * line18=
 		"-s, --separator [str]	sets the separator between sentences to \"str\"\n";
 	char * line19=
 		"			ignored if repeat is set to 1 (default)\n";
 	char * line20=
 		"			default is 2 \"newlines\"\n";
+	char * line20c=
+		"-S, --state FILE	with -c, covers only what FILE does not list as covered,\n";
+	char * line20d=
+		"			then updates it, creating it if needed\n";
+	char * line20a=
+		"-t, --tree MODE		parse tree printed after every random sentence: none, pretty or compact\n";
+	char * line20b=
+		"			default is pretty, none skips building the tree altogether\n";
 	char * line21=
 		"-v, --verbosity N	sets verbosity level (value overrided to a maximum of 6)\n";
 	char * line22=
@@ -206,11 +352,24 @@ print_usage()
 	printf(line2);
 	printf(line3);
 	printf(line4);
+	printf(line4a);
+	printf(line4b);
+	printf(line4c);
+	printf(line4d);
 	printf(line5);
 	printf(line6);
 	printf(line7);
+	printf(line7a);
+	printf(line7b);
+	printf(line7c);
+	printf(line7d);
+	printf(line7e);
+	printf(line7f);
+	printf(line7g);
 	printf(line8);
 	printf(line9);
+	printf(line9a);
+	printf(line9b);
 	printf(line10);
 	printf(line11);
 	printf(line12);
@@ -219,9 +378,14 @@ print_usage()
 	printf(line15);
 	printf(line16);
 	printf(line17);
+	printf(line17a);
 	printf(line18);
 	printf(line19);
 	printf(line20);
+	printf(line20c);
+	printf(line20d);
+	printf(line20a);
+	printf(line20b);
 	printf(line21);
 	printf(line22);
 	printf(line23);